@@ -76,6 +76,8 @@ typedef struct {
   BOOLEAN check_entail;  //check if the nnf entails the input cnf
   BOOLEAN count_models;  //count the models of the output nnf
   BOOLEAN model_counter; //only (weighted) model counter
+  BOOLEAN preprocess;    //simplify the cnf first, keeping its model count
+  BOOLEAN backbone;      //find the backbone of the cnf, set at level 1 from then on
   BOOLEAN help;          //help
 } c2dOptions;
 
@@ -174,6 +174,27 @@ void sat_unmark_clause(Clause* clause);
 //constructs a SatState from an input cnf file
 SatState* sat_state_new(const char* file_name);
 
+//simplifies the cnf of a sat state keeping its model count, before unit resolution is run on it
+//the variables it takes out of the other clauses are determined by the others, and each is left
+//in a unit clause of its own
+//returns 0, leaving the cnf as it was, if the cnf is found to be unsatisfiable, 1 otherwise, and
+//2, leaving the sat state as it was, for a sat state with learned clauses
+BOOLEAN sat_preprocess_count(SatState* sat_state);
+
+//failed literal probing, once sat_unit_resolution() succeeded: the literals it finds implied are
+//learned as unit clauses (set again by sat_unit_resolution()), along with binary clauses
+//returns 0 if the cnf is found to be unsatisfiable, 1 otherwise
+BOOLEAN sat_probe(SatState* sat_state);
+
+//the literals true in all models of the cnf, once sat_unit_resolution() succeeded: they are learned
+//as unit clauses (set again by sat_unit_resolution()) and placed in lits (room for sat_var_count()
+//of them), their number in count
+//returns 0 if the cnf is found to be unsatisfiable, 1 otherwise
+BOOLEAN sat_backbone(Lit** lits, c2dSize* count, SatState* sat_state);
+
+//returns the number of variables sat_preprocess_count() took out of the other clauses
+c2dSize sat_determined_var_count(const SatState* sat_state);
+
 //frees the SatState
 void sat_state_free(SatState* sat_state);
 
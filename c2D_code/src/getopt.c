@@ -25,6 +25,8 @@ const char* c2d_version();
 #define CHECK_ENTAIL 0;
 #define COUNT_MODELS 0;
 #define COUNTER      0;
+#define PREPROCESS   0;
+#define BACKBONE     0;
 
 /******************************************************************************
  * c2d options 
@@ -47,6 +49,8 @@ c2dOptions* init_options() {
   options->check_entail       = CHECK_ENTAIL;
   options->count_models       = COUNT_MODELS;
   options->model_counter      = COUNTER;
+  options->preprocess         = PREPROCESS;
+  options->backbone           = BACKBONE;
   options->help               = 0;
   return options;
 }
@@ -70,12 +74,14 @@ c2dOptions* get_options(int argc, char** argv) {
       {"check_entail",   no_argument,       0, 'E'},
       {"count_models",   no_argument,       0, 'C'},
       {"model_counter",  no_argument,       0, 'W'},
+      {"preprocess",     no_argument,       0, 'p'},
+      {"backbone",       no_argument,       0, 'B'},
       {"help",           no_argument,       0, 'h'},
       {0,                0,                 0,  0}
     };
 
     int index = 0;
-    int argument = getopt_long(argc,argv,"c:v:o:d:t:m:b:u:f:s:iECWh",long_options,&index);
+    int argument = getopt_long(argc,argv,"c:v:o:d:t:m:b:u:f:s:iECWpBh",long_options,&index);
     if(argument==-1) break;
 
     switch(argument) {
@@ -93,6 +99,8 @@ c2dOptions* get_options(int argc, char** argv) {
       case 'E': options->check_entail       = 1;             break;
       case 'C': options->count_models       = 1;             break;
       case 'W': options->model_counter      = 1;             break;
+      case 'p': options->preprocess         = 1;             break;
+      case 'B': options->backbone           = 1;             break;
       case 'h': options->help               = 1;             break;
       default:  print_help(C2D_PACKAGE,1);
     }
@@ -141,7 +149,7 @@ void print_help(const char* PACKAGE, int exit_value) {
   printf("%s: CNF to Decision-DNNF Compiler\n", PACKAGE);
   printf("%s\n",c2d_version());
 
-  printf("%s [-c .] [-v .] [-o .] [-d .] [-t .] [-m .] [-b .] [-u .] [-f .] [-s .]   [-i] [-E] [-C] [-W] [-h]\n", PACKAGE);
+  printf("%s [-c .] [-v .] [-o .] [-d .] [-t .] [-m .] [-b .] [-u .] [-f .] [-s .]   [-i] [-E] [-C] [-W] [-p] [-B] [-h]\n", PACKAGE);
    
 
   printf("  --cnf             -c FILE    set input CNF file\n");
@@ -171,6 +179,8 @@ void print_help(const char* PACKAGE, int exit_value) {
   printf("  --check_entail    -E         verify the compiled Decision-DNNF is correct by ensuring it is decomposable and also entails the input CNF\n");
   printf("  --count_models    -C         count the models of the input CNF after compiling it into a Decision-DNNF\n");
   printf("  --model_counter   -W         count the (weighted) models of the input CNF without compiling it into a Decision-DNNF\n");
+  printf("  --preprocess      -p         simplify the input CNF first, keeping its model count (subsumption, units, variables defined by gates, probing)\n");
+  printf("  --backbone        -B         find the literals true in all models of the CNF, and set them before compiling\n");
   printf("  --help            -h         print this help and exit\n");
   exit(exit_value);
 }
@@ -44,6 +44,39 @@ int main(int argc, char* argv[]) {
   printf("Clauses=%"PRIvS"",sat_clause_count(sat_state));
   printf("\n  CNF Time\t%0.3fs",((double)(sat_t))/CLOCKS_PER_SEC);
 
+  //simplify CNF (the count of the input CNF is kept)
+  if(options->preprocess) {
+    start_t = clock();
+    printf("\nPreprocessing CNF..."); fflush(stdout);
+    if(sat_preprocess_count(sat_state)) {
+      if(sat_unit_resolution(sat_state)) sat_probe(sat_state); //learns units and binary clauses
+      sat_undo_unit_resolution(sat_state);
+    }
+    clock_t prep_t = clock()-start_t;
+    printf(" DONE");
+    printf("\nCNF stats: ");
+    printf("\n  Vars=%"PRIvS" / ",sat_var_count(sat_state));
+    printf("Clauses=%"PRIvS" / ",sat_clause_count(sat_state));
+    printf("Determined vars=%"PRIvS" / ",sat_determined_var_count(sat_state));
+    printf("Learned clauses=%"PRIvS"",sat_learned_clause_count(sat_state));
+    printf("\n  Preprocess Time\t%0.3fs",((double)(prep_t))/CLOCKS_PER_SEC);
+  }
+
+  //find the backbone, which unit resolution sets at level 1 from then on
+  if(options->backbone) {
+    start_t = clock();
+    printf("\nComputing backbone..."); fflush(stdout);
+    Lit** backbone = (Lit**)malloc(sizeof(Lit*)*(sat_var_count(sat_state)+1));
+    c2dSize backbone_count = 0;
+    if(sat_unit_resolution(sat_state)) sat_backbone(backbone,&backbone_count,sat_state);
+    sat_undo_unit_resolution(sat_state);
+    free(backbone);
+    clock_t backbone_t = clock()-start_t;
+    printf(" DONE");
+    printf("\n  Backbone=%"PRIvS" literals",backbone_count);
+    printf("\n  Backbone Time\t%0.3fs",((double)(backbone_t))/CLOCKS_PER_SEC);
+  }
+
   //construct Vtree
   start_t = clock();
   printf("\nConstructing vtree (from %s)...",vtree_type(options)); fflush(stdout);
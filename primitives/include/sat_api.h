@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 
 /******************************************************************************
  * sat_api.h shows the function prototypes you should implement to create libsat.a
@@ -37,6 +38,9 @@ typedef char BOOLEAN; //signed
 typedef unsigned long c2dSize;  //for variables, clauses, and various things
 typedef signed long c2dLiteral; //for literals
 typedef double c2dWmc;          //for (weighted) model count
+typedef uint32_t LitCode;       //literal inside a clause: 2(i-1) for literal i, 2(i-1)+1 for literal -i
+typedef uintptr_t Reason;       //reason of an implied literal: a Clause*, (code<<1)|1 for the binary clause
+                                //whose other literal (false) has that code, 0 for a decision
 /******************************************************************************
  * general settings 
  ******************************************************************************/
@@ -44,6 +48,28 @@ static const BOOLEAN DEBUG = 0;  //for debug assert_test
 static const BOOLEAN PRINT = 0;  //for print information to terminal
 static const BOOLEAN CON = 0;  //for conflict driven method
 //0 1UIP  1 conflictSet
+static const BOOLEAN MINIMIZE = 2;  //for minimizing the 1UIP learned clause
+//0 none  1 local  2 recursive
+static const c2dSize REDUCE_FIRST = 2000;  //learned clauses kept before the first reduction
+static const c2dSize REDUCE_INC = 300;  //growth of the reduction interval after each reduction
+static const double CLAUSE_DECAY = 0.999;  //decay of learned clause activities, per learned clause
+static const double VAR_DECAY = 0.95;  //decay of variable activities, per conflict, for sat_next_decision()
+static const BOOLEAN PHASE = 2;  //the literal sat_next_decision() gives for its variable
+//0 positive  1 saved, the value it had last  2 target, its value in the largest trail without conflict, else saved
+static const c2dSize RESTART_UNIT = 100;  //conflicts of the shortest run of sat_solve() and of the sat solver, the runs follow sat_luby()
+static const c2dSize PREP_OCCUR_LIMIT = 16;  //a variable with more clauses for each of its literals is not eliminated
+static const c2dSize PREP_RESOLVENT_LIMIT = 24;  //longest resolvent an elimination may add
+static const c2dSize PREP_SUBSUME_LIMIT = 1000;  //clauses of a variable searched for clauses subsumed by one of them
+static const c2dSize PREP_STEPS = 200000000;  //bound of the preprocessing work, in literals visited
+static const c2dSize PROBE_STEPS = 5000000;  //literals the probes of a probing pass may set in all (a second or less)
+static const BOOLEAN PROBE_ORDER = 1;  //the variables probed, and in which order
+//0 all, by index  1 all, those in more binary clauses first  2 roots of the binary clauses only
+static const BOOLEAN XOR_GAUSS = 1;  //find the xors among the cnf clauses and propagate them as rows of bits
+#define XOR_MAX_VARS 6  //the value of XOR_MAX_SIZE, as a constant that can size arrays, at most 6 (see xor.c)
+static const c2dSize XOR_MAX_SIZE = XOR_MAX_VARS;  //longest clauses looked at for xors, an xor of k variables has 2^(k-1)
+static const c2dSize XOR_MATRIX_LIMIT = 1<<22;  //words of 64 bits the rows may take, no rows beyond it
+static const BOOLEAN CARD_DETECT = 1;  //sat_cardinality() replaces the cliques of binary clauses by at-most-one constraints
+static const c2dSize CARD_MIN_SIZE = 4;  //fewest literals of such a constraint
 //static const BOOLEAN ADD = 1;  //add literal exist for the learned clause
 #define ASSERT_TEST(test_case) {if (DEBUG) assert(test_case);}
 /******************************************************************************
@@ -60,6 +86,7 @@ typedef struct var {
   c2dSize               index; //variable index (1-n)
   struct literal*       pos; //positive literal
   struct literal*       neg; //negative literal
+  const c2dSize*        unsubsumed; //SatState::varUnsubsumed, for the calls that only get the variable
   BOOLEAN               mark; //THIS FIELD MUST STAY AS IS
 } Var;
 /******************************************************************************
@@ -71,16 +98,12 @@ typedef struct var {
  ******************************************************************************/
 typedef struct literal {  
   c2dLiteral            index; //literal index (-2n~-1 1~2n)
+  LitCode               code; //code of this literal, opp has code^1, indexes the per literal arrays of SatState
   struct var*           var;  //the variable for this literal
   struct literal*       opp; //the opposite literal
+  const c2dSize*        level; //SatState::litLevel, for the calls that only get the literal
   struct clause**       occurIn; //clauses that mention this literal
   c2dSize               occurSize; //number of clauses that mention this literal
-
-  c2dSize               setLevel; //the level that this literal is set (decided/implied)  0 for not implied
-  BOOLEAN               inQueue; // for unit-resolution, whether already in the tosetList
-
-  BOOLEAN               seen; // for conflict driven
-  struct clause*        reason; //the reason for this literal (if exist)
 } Lit;
 /******************************************************************************
  * Clauses: 
@@ -93,12 +116,107 @@ typedef struct literal {
  ******************************************************************************/
 typedef struct clause {  
   c2dSize               index;  //clause index   (you can change the variable name as you wish)
-  struct literal**      lits; //literal array  (you can change the variable name as you wish)
   c2dSize               size; //size of a clause
-  c2dSize               falseLit; //number of literals set to false in this clause
   c2dSize               setLevel; //the level that this clause is subsumed initial 0
+  double                activity; //for learned clauses, bumped when used in conflict analysis
+  c2dSize               lbd; //for learned clauses, number of distinct levels among its literals
+  struct literal*       table; //literals of the sat state, in code order
+  struct literal**      lits; //literal array for sat_clause_literals(), only built on request
+  BOOLEAN               removed; //deleted by the learned clause reduction, to be freed
+  BOOLEAN               imported; //learned by another sat state, see sat_import_clause()
   BOOLEAN               mark; //THIS FIELD MUST STAY AS IS
+  LitCode               codes[]; //literals stored with the clause, codes[0] and codes[1] are the watched literals
 } Clause;
+/******************************************************************************
+ * WatchList: clauses watching a literal, visited when the literal becomes false
+ ******************************************************************************/
+typedef struct watch_list {
+  struct clause**     clauses;
+  c2dSize             size;
+  c2dSize             cap;
+} WatchList;
+/******************************************************************************
+ * BinaryList: the other literals of the binary clauses of a literal, each one
+ * is implied when the literal becomes false
+ * TernaryList: the other two literals of the ternary clauses of a literal
+ ******************************************************************************/
+typedef struct binary_list {
+  LitCode*            others;
+  c2dSize             size;
+  c2dSize             cap;
+} BinaryList;
+typedef struct ternary {
+  LitCode             a;
+  LitCode             b;
+  struct clause*      clause;
+} Ternary;
+typedef struct ternary_list {
+  Ternary*            entries;
+  c2dSize             size;
+  c2dSize             cap;
+} TernaryList;
+/******************************************************************************
+ * PrepStats: what sat_preprocess() did
+ ******************************************************************************/
+typedef struct prep_stats {
+  c2dSize             clausesBefore;
+  c2dSize             clausesAfter;
+  c2dSize             varsBefore; //variables mentioned by a clause
+  c2dSize             varsAfter;
+  c2dSize             fixed; //variables set by unit clauses
+  c2dSize             substituted; //variables replaced by an equivalent literal
+  c2dSize             subsumed; //clauses removed by backward subsumption
+  c2dSize             strengthened; //literals removed by self-subsuming resolution
+  c2dSize             eliminated; //variables removed by bounded variable elimination
+  c2dSize             gates; //eliminated variables that a gate among their clauses defines
+  c2dSize             resolvents; //clauses added by the eliminations
+  double              substituteTime; //seconds spent on equivalent literals
+  double              subsumeTime; //seconds spent on subsumption and strengthening
+  double              eliminateTime; //seconds spent on variable elimination
+  double              time; //seconds in all
+} PrepStats;
+/******************************************************************************
+ * ProbeStats: what sat_probe() did
+ ******************************************************************************/
+typedef struct probe_stats {
+  c2dSize             probed; //literals decided
+  c2dSize             failed; //probes that ended in a conflict
+  c2dSize             lifted; //literals implied by both literals of a variable
+  c2dSize             hyper; //hyper-binary resolvents learned
+  double              time; //seconds in all
+} ProbeStats;
+/******************************************************************************
+ * XorStats: the xors of the cnf, see xor.c
+ ******************************************************************************/
+typedef struct xor_stats {
+  c2dSize             found; //xors whose clauses are all in the cnf
+  c2dSize             rows; //rows left by the elimination
+  c2dSize             columns; //variables of the rows
+  c2dSize             implied; //literals the rows implied
+  c2dSize             conflicts; //conflicts found by the rows
+} XorStats;
+/******************************************************************************
+ * CardStats: the at-most-one constraints of sat_cardinality(), see card.c
+ ******************************************************************************/
+typedef struct card_stats {
+  c2dSize             groups; //constraints
+  c2dSize             exactlyOne; //constraints whose literals are also a clause of the cnf
+  c2dSize             literals; //literals in them
+  c2dSize             binaries; //binary clauses they replaced
+  c2dSize             implied; //literals they set false
+  c2dSize             conflicts; //conflicts found by them
+  double              time; //seconds spent finding them
+} CardStats;
+/******************************************************************************
+ * SolveStats: the calls of sat_solve() on a sat state
+ ******************************************************************************/
+typedef struct solve_stats {
+  c2dSize             solves; //calls
+  c2dSize             unsatisfiable; //calls that found no model under their assumptions
+  c2dSize             conflicts;
+  c2dSize             restarts;
+  c2dSize             added; //clauses given to sat_add_clause()
+} SolveStats;
 /******************************************************************************
  * SatState: 
  * --The following structure will keep track of the data needed to
@@ -108,18 +226,83 @@ typedef struct sat_state_t {
   struct clause**     delta; //database, clauses for this cnf
 
   struct var**        variables; //variables in cnf
+  struct var*         varPool; //the n variables, variables points into it
+  struct literal*     literals; //the 2n literals, in code order
+
+  c2dSize*            litLevel; //per literal code: the level that the literal is set (decided/implied), 0 for not set
+  Reason*             litReason; //per literal code: the reason for the literal (if exist)
+  BOOLEAN*            litSeen; //per literal code: for conflict driven
+  BOOLEAN*            litQueued; //per literal code: whether already in the queue of pending literals
+  c2dSize*            varUnsubsumed; //per variable (index-1): clauses mentioning it that are not subsumed
+  WatchList*          watches; //per literal code, clauses of 4 literals or more
+  BinaryList*         binaries; //per literal code, binary clauses
+  TernaryList*        ternaries; //per literal code, ternary clauses
+  struct clause*      binaryConflict; //stands for a binary clause found in conflict
+  struct clause*      binaryReason; //stands for the binary clause of a tagged reason
   c2dSize             n; //number of variables
   c2dSize             m; //number of clauses in original database
   c2dSize             l; //number of learned clauses
+  c2dSize             deltaCap; //capacity of delta
+
+  char*               arena; //current block of the cnf clauses, blocks are chained by their first word
+  c2dSize             arenaUsed; //bytes used in the current block
+  c2dSize             arenaSize;
+  struct clause**     occurPool; //occurrence lists of all literals, sized by the first parsing pass
+  c2dSize             parseBytes; //size of the cnf file
+  double              parseTime; //seconds spent mapping and parsing it
+  struct clauseStore* pending; //clauses given to a sat state being built, until sat_state_build()
+  LitCode*            elimStack; //clauses of the variables set or eliminated by sat_preprocess(), each
+                                 //followed by its size, its first literal is the one it sets
+  c2dSize             elimSize;
+  c2dSize             elimCap;
+  PrepStats           prepStats;
+  c2dSize             determined; //variables sat_preprocess_count() set by a unit clause, each set by the others
+  ProbeStats          probeStats;
+  struct xorMatrix*   xorRows; //the xors of the cnf as rows of bits, NULL if none
+  XorStats            xorStats;
+  struct card*        card; //at-most-one constraints that replaced binary clauses of the cnf, NULL if none
+  CardStats           cardStats;
+  BOOLEAN             empty; //the empty clause is in the cnf, was added, or learned at level 1: the cnf is unsatisfiable
+  SolveStats          solveStats;
+
+  double              clauseInc; //activity added to a learned clause when it is bumped
+  double*             varActivity; //per variable (index-1): raised when conflict analysis meets it
+  double              varInc; //activity added to a variable when it is bumped
+  c2dSize*            heap; //variables by activity, a binary heap that holds at least the free ones
+  c2dSize*            heapPos; //per variable: its place in heap
+  c2dSize             heapSize;
+  BOOLEAN             phase; //the literal sat_phase_literal() gives, PHASE unless sat_set_phase() changed it
+  BOOLEAN*            varPhase; //per variable: 1 if its last value was true (saved phase)
+  BOOLEAN*            varTarget; //per variable: 1 if it was true in the target trail (target phase)
+  c2dSize             targetSize; //literals of the target trail, the largest trail without conflict
+  c2dSize             targetSame; //literals of set still those of the target trail
+  c2dSize*            levelStamp; //per level, for counting the distinct levels of a clause
+  c2dSize             stamp;
+  c2dSize             reduceLimit; //reduce the learned clauses when l reaches this
+  c2dSize             reduceInc;
+  c2dSize             deleted; //number of learned clauses deleted by reductions
 
   c2dSize             currentLevel; 
   c2dSize             assertionLevel;
   
   struct literal*     learned;  // literal implied by learned clause
-  struct literal**    set;  //currently implied
+  struct literal**    set;  //currently implied, in the order they were implied
   c2dSize             setCount;
+  c2dSize             setHead; //literals of set before setHead have been propagated
+  c2dSize             xorHead; //literals of set before xorHead have been given to the xor rows
+
+  struct clause**     units; // unit clauses, from the cnf or learned
+  c2dSize             unitCount;
+  c2dSize             unitCap;
+
+  struct literal**    learnBuffer; // scratch space where conflict analysis builds the learned clause
+  struct literal**    minStack; // scratch space for the reason chains walked by minimization
+  struct literal**    minClear; // literals marked seen by minimization, to be cleared
+  c2dSize             minClearCount;
+  c2dSize             minLocal; // literals removed from learned clauses by their own reason
+  c2dSize             minRecursive; // literals removed through a chain of reasons
 
-  struct literal**    queue; // resolution queue
+  struct literal**    queue; // pending literals (decision or asserted) for the next unit resolution
   c2dSize             queueSize; 
   BOOLEAN             conflict; //existence of conflict
   //char                resolutionType; //type used in unit-resolution
@@ -197,6 +380,32 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state);
 //undoes the last literal decision and the corresponding implications obtained by unit resolution
 void sat_undo_decide_literal(SatState* sat_state);
 
+//undoes the decisions above level, and the literals implied at their levels, in one pass over
+//the literals set (sat_undo_decide_literal() once per level, but in one call), the decision level
+//becomes level; sat_backtrack(1,...) restarts the search, the learned clauses are kept
+void sat_backtrack(c2dSize level, SatState* sat_state);
+
+//returns the literal of the free variable to decide next, NULL if every variable is set
+//the variables are taken by activity, raised for those met by conflict analysis and decayed by
+//VAR_DECAY after each conflict (the lower index first among equal ones), the literal is the
+//one sat_phase_literal() gives
+Lit* sat_next_decision(SatState* sat_state);
+
+//returns the literal of a variable that the phase of sat state (PHASE by default) prefers: the
+//positive one, the one set last (saved phase, kept when the variable is unset), or the one set in
+//the largest trail that unit resolution left without conflict (target phase, for the variables of
+//that trail)
+Lit* sat_phase_literal(const Var* var, const SatState* sat_state);
+
+//sets the phase of sat state, as PHASE: 0 (positive), 1 (saved) or 2 (target)
+void sat_set_phase(BOOLEAN phase, SatState* sat_state);
+
+//gives the variables random activities drawn from seed, all below the first bump, so that
+//sat_next_decision() starts from another order (the same one for the same seed), for searches of
+//the same cnf that should not all take the same path; seed 0 gives them all 0, the order by index
+//for a sat state at level 1 before any conflict
+void sat_seed_order(c2dSize seed, SatState* sat_state);
+
 /******************************************************************************
  * Clauses 
  ******************************************************************************/
@@ -210,6 +419,10 @@ c2dSize sat_clause_index(const Clause* clause);
 //returns the literals of a clause
 Lit** sat_clause_literals(const Clause* clause);
 
+//returns the index (i or -i for variable i) of the literal at position i of a clause, from 0 to its
+//size-1, without building the literal array of sat_clause_literals()
+c2dLiteral sat_clause_literal_index(c2dSize i, const Clause* clause);
+
 //returns the number of literals in a clause
 c2dSize sat_clause_size(const Clause* clause);
 
@@ -222,6 +435,18 @@ c2dSize sat_clause_count(const SatState* sat_state);
 //returns the number of learned clauses in a sat state (0 when the sat state is constructed)
 c2dSize sat_learned_clause_count(const SatState* sat_state);
 
+//adds a clause of size literals (i or -i for variable i) to the cnf of a sat state that is not being
+//built, between calls of sat_solve(): unit resolution must not have been run, or been undone
+//the clause is kept with the learned clauses (so sat_learned_clause_count() counts it), it is never
+//deleted by their reduction, and sat_clause_count() does not change; sat_preprocess(),
+//sat_preprocess_count() and sat_state_save() then refuse the sat state, since it is not all in the cnf
+//returns 0, adding nothing, if a literal is not one of the variables
+BOOLEAN sat_add_clause(const c2dLiteral* literals, c2dSize size, SatState* sat_state);
+
+//returns the number of distinct decision levels among the literals of a learned clause (its lbd),
+//as it was learned or as low as conflict analysis has seen it since
+c2dSize sat_clause_lbd(const Clause* clause);
+
 //adds clause to the set of learned clauses, and runs unit resolution
 //returns a learned clause if unit resolution finds a contradiction, NULL otherwise
 //
@@ -233,9 +458,119 @@ Clause* sat_assert_clause(Clause* clause, SatState* sat_state);
  * SatState
  ******************************************************************************/
 
-//constructs a SatState from an input cnf file
+//constructs a SatState from an input cnf file (dimacs, or a snapshot written by sat_state_save())
+//the xors whose clauses are all in the cnf are found (see XOR_GAUSS) and also propagated as rows
 SatState* sat_state_new(const char* file_name);
 
+//constructs a SatState over n variables from m clauses in memory, clause i has sizes[i] literals
+//and the literals of the clauses follow one another in literals (i or -i for variable i)
+//returns NULL if a literal is not one of the n variables
+SatState* sat_state_from_clauses(c2dSize n, c2dSize m, const c2dSize* sizes, const c2dLiteral* literals);
+
+//starts a SatState over n variables, its clauses are given by sat_state_add_clause(), then
+//sat_state_build() makes it a SatState like one from sat_state_new()
+SatState* sat_state_builder(c2dSize n);
+
+//adds a clause of size literals (i or -i for variable i) to a SatState that is being built
+//a clause of size 0 is the empty clause, sat_unit_resolution() then fails on the SatState built
+//returns 0, adding nothing, if a literal is not one of the variables
+BOOLEAN sat_state_add_clause(const c2dLiteral* literals, c2dSize size, SatState* sat_state);
+
+//ends the building of a SatState, the clauses are indexed in the order they were added
+void sat_state_build(SatState* sat_state);
+
+//writes the cnf of sat state as a binary snapshot, that sat_state_new() loads
+//without parsing (learned clauses are not written)
+//returns 1 on success, 0 otherwise (and for a sat state with constraints from sat_cardinality(), or
+//clauses from sat_add_clause())
+BOOLEAN sat_state_save(const SatState* sat_state, const char* file_name);
+
+//simplifies the cnf of a sat state on which unit resolution has not been run yet, by equivalent
+//literals, unit clauses, backward subsumption, self-subsuming resolution and bounded variable
+//elimination
+//the cnf is replaced by the simplified clauses (indexed from 1), which mention none of the
+//variables that were set, substituted or eliminated, see sat_extend_model() for the models of the cnf
+//returns 0, leaving the cnf as it was, if the cnf is found to be unsatisfiable, 1 otherwise
+//returns 2, leaving the sat state as it was, if it has learned clauses or clauses from
+//sat_add_clause(), which are not in the cnf it simplifies; the sat state is then still
+//searched as it is, so a caller may take any answer but 0 as "not found unsatisfiable"
+BOOLEAN sat_preprocess(SatState* sat_state);
+
+//like sat_preprocess(), but keeping the model count: equivalent literals, unit clauses, subsumption, self-subsuming
+//resolution, and the elimination of variables defined by a gate among their clauses (equivalent
+//to another literal, or to an and/or of other literals) only, so each variable it takes out of
+//the other clauses is set by the others
+//each of them is then left in a unit clause of its own, so the cnf left has as many models
+//(over all the variables) as the cnf it was given
+//returns 0, leaving the cnf as it was, if the cnf is found to be unsatisfiable, 1 otherwise, and
+//like sat_preprocess() 2 for a sat state with learned clauses or clauses from sat_add_clause()
+BOOLEAN sat_preprocess_count(SatState* sat_state);
+
+//returns the number of variables sat_preprocess_count() took out of the other clauses, each
+//left in a unit clause of its own
+c2dSize sat_determined_var_count(const SatState* sat_state);
+
+//replaces each literal by the representative of its class of equivalent literals, found as the
+//strongly connected components of the binary clauses (cnf and learned), then sets the unit
+//clauses this leaves; sat_preprocess() and sat_preprocess_count() start with the same step
+//unlike them it can run between restarts, once unit resolution is undone: the learned clauses
+//are rewritten the same way and kept
+//returns 0, leaving the cnf as it was, if the cnf is found to be unsatisfiable, 1 otherwise
+BOOLEAN sat_substitute_equivalences(SatState* sat_state);
+
+//replaces the pairwise encodings of at-most-one constraints among the binary clauses of the cnf,
+//of CARD_MIN_SIZE literals or more, by native constraints that unit resolution propagates
+//through counters; the cnf left is indexed from 1, without these binary clauses, so this is for
+//the sat solver, not the knowledge compiler; sat_preprocess() and sat_preprocess_count() see the
+//constraints as their binary clauses, and find them again on the cnf they leave
+//for a sat state on which unit resolution has not been run yet, without learned clauses
+//returns the number of constraints found
+c2dSize sat_cardinality(SatState* sat_state);
+
+//decides whether the cnf (with the clauses added and learned so far) has a model in which the count
+//assumptions are true: they are decided first, in order, then the search goes on like the sat solver
+//(sat_next_decision(), restarts every RESTART_UNIT times a term of the luby sequence conflicts)
+//unit resolution must not have been run, or been undone; the learned clauses are kept for the next calls
+//and everything else is undone before it returns
+//returns 1 if there is one, and then model (when not NULL) gets it: model[i-1] is 1 if variable i is true
+//returns 0 otherwise, and then failed (room for count literals) gets assumptions that the cnf
+//contradicts by themselves, their number in failedCount (0 when the cnf is unsatisfiable)
+BOOLEAN sat_solve(Lit** assumptions, c2dSize count, BOOLEAN* model, Lit** failed, c2dSize* failedCount,
+                  SatState* sat_state);
+
+//adds a clause of size literals (i or -i for variable i) learned by another sat state of the same cnf,
+//where it has that lbd, to the learned clauses, at level 1 once sat_unit_resolution() succeeded:
+//unlike the clauses of sat_add_clause(), the reduction of learned clauses may delete it, whatever its lbd
+//(but for unit and binary clauses); its literals false at level 1 are left out, it is not added if one
+//is true, and a unit clause has its literal set, like sat_assert_clause() does
+//returns 0 if the cnf is then found unsatisfiable, 1 otherwise
+BOOLEAN sat_import_clause(const c2dLiteral* literals, c2dSize size, c2dSize lbd, SatState* sat_state);
+
+//returns the i^th term (from 1) of the luby sequence 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ..., the length of
+//run i of a search that restarts, in RESTART_UNIT conflicts
+c2dSize sat_luby(c2dSize i);
+
+//failed literal probing, at level 1 once sat_unit_resolution() succeeded: each candidate variable
+//(see PROBE_ORDER) has its literals decided in turn, a literal that fails has its opposite set,
+//a literal both imply is set, and hyper-binary resolvents are learned along the way
+//what it sets stays set at level 1, and is set again by sat_unit_resolution() through the unit
+//clauses it learns (the clauses it learns are implied by the cnf, the model count is kept)
+//returns 0 if the cnf is found to be unsatisfiable, 1 otherwise
+BOOLEAN sat_probe(SatState* sat_state);
+
+//the backbone of the cnf, the literals true in all its models, at level 1 once sat_unit_resolution()
+//succeeded: the literals of a model are the candidates, each is checked by searching for a model
+//with its opposite, and the models found drop the candidates they do not share
+//the literals are left set at level 1, learned as unit clauses so sat_unit_resolution() sets them
+//again, and placed in lits (room for sat_var_count() of them), their number in count
+//returns 0 if the cnf is found to be unsatisfiable, 1 otherwise
+BOOLEAN sat_backbone(Lit** lits, c2dSize* count, SatState* sat_state);
+
+//turns a model of the cnf left by sat_preprocess() into a model of the cnf it was given, by
+//setting the variables it set, substituted or eliminated
+//model[i-1] is 1 if variable i is true, 0 if it is false
+void sat_extend_model(const SatState* sat_state, BOOLEAN* model);
+
 //frees the SatState
 void sat_state_free(SatState* sat_state);
 
@@ -254,6 +589,10 @@ void sat_undo_unit_resolution(SatState* sat_state);
 //it is used to decide whether the sat state is at the right decision level for adding clause.
 BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state);
 
+//returns the assertion level of clause, the last clause learned, 0 if it is empty (the cnf is
+//unsatisfiable); sat_backtrack() to this level lets sat_assert_clause() add the clause
+c2dSize sat_assertion_level(const Clause* clause, const SatState* sat_state);
+
 /******************************************************************************
  * The functions below are already implemented for you and MUST STAY AS IS
  ******************************************************************************/
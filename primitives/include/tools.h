@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "sat_api.h"
 
@@ -14,6 +15,200 @@ typedef struct litlink {
   struct litlink*     next;
 } LitLink;
 
+#define LEVEL_BIT(level) (1UL << ((level) & 63))  // level abstraction used by minimization
+
+#define ARENA_BLOCK (1UL << 20)  // bytes of one block of the clause arena
+#define CLAUSE_BYTES(size) (sizeof(Clause)+(size)*sizeof(LitCode))
+#define ARENA_ROUND(bytes) (((bytes)+7) & ~(c2dSize)7)  // keeps the clause headers aligned
+// binary snapshot of a parsed cnf, see snapshotLoad()
+#define SNAPSHOT_MAGIC "libsat\x01\n"  // 8 bytes, the last but one is the version
+
+typedef struct snapshotHeader {
+  char                magic[8];
+  c2dSize             n;
+  c2dSize             m;
+  c2dSize             codeCount; // literals of all the clauses
+  c2dSize             occurCount; // entries of all the occurrence lists
+  c2dSize             arenaBytes; // arena space of the clauses
+} SnapshotHeader;
+
+#define SNAPSHOT_BYTES(h) (sizeof(SnapshotHeader)+sizeof(c2dSize)*((h)->m+1+2*(h)->n+1) \
+                           +sizeof(uint32_t)*(h)->occurCount+sizeof(LitCode)*(h)->codeCount)
+
+// clauses given as literal codes, before they are placed by storeBuild()
+typedef struct clauseStore {
+  LitCode*            codes; // codes of the clauses, one after the other
+  c2dSize             codeCount;
+  c2dSize             codeCap;
+  c2dSize*            starts; // start of each clause in codes, one more than count
+  c2dSize             count; // closed clauses, the codes after the last start are the open one
+  c2dSize             startCap;
+} ClauseStore;
+
+#define LITERAL_CODE(index) ((index)>0 ? 2*((LitCode)(index)-1) : 2*((LitCode)-(index)-1)+1)
+
+// compressed input, decompressed by a second thread while it is parsed
+#define STREAM_CHUNK (1UL << 20)  // bytes of text in one chunk of the ring
+#define STREAM_CHUNKS 4  // chunks of the ring
+#define STREAM_INPUT (1UL << 18)  // bytes of compressed input read at once
+
+typedef enum { CODEC_NONE, CODEC_GZIP, CODEC_XZ, CODEC_ZSTD } Codec;
+
+typedef struct stream {
+  FILE*               in;
+  Codec               codec;
+  unsigned char       prefix[8]; // bytes read to find the codec, decompressed first
+  c2dSize             prefixSize;
+  char*               chunks[STREAM_CHUNKS];
+  c2dSize             sizes[STREAM_CHUNKS];
+  c2dSize             head; // chunks the parser is done with
+  c2dSize             tail; // chunks filled by the decompressing thread
+  BOOLEAN             done;
+  BOOLEAN             failed;
+  pthread_mutex_t     lock;
+  pthread_cond_t      filled;
+  pthread_cond_t      emptied;
+} Stream;
+
+typedef struct textParse {
+  BOOLEAN             header; // problem line read
+  BOOLEAN             open; // inside a clause
+  BOOLEAN             stop; // the text after the clauses is ignored
+  ClauseStore         store; // clauses read so far
+} TextParse;
+
+// the cnf while sat_preprocess() simplifies it, see preprocess.c
+typedef struct occurList {
+  c2dSize*            ids; // clauses with the literal, removed ones are dropped when the list is visited
+  c2dSize             size;
+  c2dSize             cap;
+} OccurList;
+
+typedef struct prep {
+  ClauseStore         store; // codes of the clauses, resolvents are added after the cnf clauses
+  c2dSize*            sizes; // per clause: literals left, the first ones of its codes
+  uint64_t*           signs; // per clause: a bit for the variable of each literal
+  BOOLEAN*            removed; // per clause
+  BOOLEAN*            queued; // per clause: in queue
+  c2dSize             clauseCap;
+  c2dSize*            queue; // clauses that may subsume or strengthen others
+  c2dSize             queueSize;
+  c2dSize             queueCap;
+  OccurList*          occurs; // per literal code
+  c2dSize*            counts; // per literal code: clauses left with the literal
+  BOOLEAN*            marks; // per literal code, scratch
+  BOOLEAN*            value; // per literal code: set by a unit clause
+  LitCode*            repr; // per literal code: the literal of its equivalence class that replaces it
+  LitCode*            units; // literals of unit clauses, set from unitHead on
+  c2dSize             unitHead;
+  c2dSize             unitCount;
+  c2dSize             unitCap;
+  BOOLEAN*            gone; // per variable: set or eliminated
+  BOOLEAN*            touched; // per variable: in touchList, its clauses changed
+  c2dSize*            touchList;
+  c2dSize             touchCount;
+  c2dSize*            ids; // scratch for the clauses of a variable
+  BOOLEAN*            gate; // per entry of ids: the clause is one of the gate found by prepGate()
+  c2dSize             idCap;
+  LitCode*            buffer; // scratch for a resolvent
+  c2dSize             steps; // literals visited, up to PREP_STEPS
+  BOOLEAN             count; // keep the model count, see sat_preprocess_count()
+  BOOLEAN             card; // the sat state had at-most-one constraints, found again by prepFinish()
+  BOOLEAN             unsat;
+} Prep;
+
+// failed literal probing, see probe.c
+typedef struct probe {
+  c2dSize*            stamps; // per literal code: the last variable whose first probe implied it
+  c2dSize             stamp;
+  LitCode*            lifted; // literals implied by both probes of a variable
+  c2dSize             liftedCount;
+  LitCode*            hyper; // hyper-binary resolvents of a probe, two codes each
+  c2dSize             hyperCount;
+  c2dSize             hyperCap;
+  c2dSize             steps; // literals set by the probes, up to PROBE_STEPS
+} Probe;
+
+// backbone, see backbone.c
+typedef struct backbone {
+  BOOLEAN*            model; // per variable (index-1): its value in the last model
+  BOOLEAN*            value; // per variable: its value in the first model
+  BOOLEAN*            candidate; // per variable: the literal of value may be in the backbone
+} Backbone;
+
+// the xors of the cnf, see xor.c
+typedef struct xorMatrix {
+  c2dSize             rows;
+  c2dSize             columns;
+  c2dSize             words; // per row, of 64 bits, a bit per column
+  uint64_t*           bits; // rows after rows
+  c2dSize*            low; // per row: its first word with bits
+  c2dSize*            high; // per row: past its last word with bits
+  uint64_t*           assigned; // a bit per column set
+  uint64_t*           value; // a bit per column set to true
+  BOOLEAN*            rhs; // per row: what its columns sum to
+  c2dSize*            basic; // per row: its column no other row has
+  c2dSize*            watch; // per row: another column it has, XOR_NONE if none
+  c2dSize*            basicRow; // per column: the row it is basic in, XOR_NONE if none
+  c2dSize*            colVar; // per column: its variable (index-1)
+  c2dSize*            varCol; // per variable: its column, XOR_NONE if none
+  OccurList*          watchers; // per column: rows that watch it
+  struct clause**     reasons; // per column: reason of its last implication
+  c2dSize*            reasonCap; // per column: literals its reason has room for
+  struct clause*      conflict; // the last conflict of a row
+  c2dSize             conflictCap;
+} XorMatrix;
+
+// the at-most-one constraints, see card.c
+typedef struct card {
+  c2dSize             count;
+  c2dSize*            starts; // per constraint: its first literal in codes, then the end of the last one
+  LitCode*            codes; // at most one of the literals of a constraint is true
+  c2dSize*            trues; // per constraint: its literals set true
+  c2dSize*            falses; // per constraint: its literals set false
+  OccurList*          lists; // per literal code: the constraints with the literal
+} Card;
+
+// the binary clauses of the cnf, as the edges of the literals that may not both be true
+typedef struct cardEdges {
+  c2dSize*            starts; // per literal code: its first edge, then the end of the last one
+  LitCode*            others; // per edge: the other literal
+  c2dSize*            ids; // per edge: its clause, 0 based
+  c2dSize*            stamps; // per literal code: the last cardHit() it was counted by
+  c2dSize             stamp;
+} CardEdges;
+
+// a cnf clause that may belong to an xor
+typedef struct xorGroup {
+  uint64_t            hash; // of its variables
+  c2dSize             vars[XOR_MAX_VARS]; // in order
+  c2dSize             size;
+  c2dSize             signs; // a bit per variable with a negative literal, the sum once a row
+} XorGroup;
+
+#define PREP_SIGN(code) (((uint64_t)1) << (((code)>>1) & 63))
+#define PREP_TAUTOLOGY (~(c2dSize)0)  // what prepResolve() returns for a tautology
+
+#define CLAUSE_LIT(clause, i, sat_state) (&(sat_state)->literals[(clause)->codes[i]])
+
+// the per literal state of SatState, by literal
+#define LEVEL(lit, sat_state) ((sat_state)->litLevel[(lit)->code])
+#define OPP_LEVEL(lit, sat_state) ((sat_state)->litLevel[(lit)->code^1])  // the literal is false when > 0
+#define REASON(lit, sat_state) ((sat_state)->litReason[(lit)->code])
+
+// tagged reasons, for literals implied by a binary clause
+#define REASON_BINARY(code) ((((Reason)(code))<<1)|1)
+#define REASON_IS_BINARY(reason) ((reason)&1)
+#define REASON_CODE(reason) ((LitCode)((reason)>>1))
+#define XOR_NONE (~(c2dSize)0)
+#define HEAP_NONE (~(c2dSize)0)  // the place of a variable that is not in the heap
+#define HEAP_BEFORE(a, b, sat_state) ((sat_state)->varActivity[a]>(sat_state)->varActivity[b] \
+                                      || ((sat_state)->varActivity[a]==(sat_state)->varActivity[b] && (a)<(b)))
+#define XOR_ROW(matrix, row) ((matrix)->bits+(size_t)(row)*(matrix)->words)
+#define XOR_BIT(matrix, row, column) ((XOR_ROW(matrix, row)[(column)/64] >> ((column)%64)) & 1)
+#define SEEN(lit, sat_state) ((sat_state)->litSeen[(lit)->code])
+#define QUEUED(lit, sat_state) ((sat_state)->litQueued[(lit)->code])
+
 /******************************************************************************
 * self-defined function tools used in sat_api.h
  ******************************************************************************/
@@ -21,27 +216,207 @@ typedef struct litlink {
 /******************************************************************************
 * for unit resolution
 *******************************************************************************/
-BOOLEAN literalSet(Lit*, SatState*);  // set the literal at current level
-BOOLEAN clauseTest(Clause*, SatState*);
+void literalAssign(Lit*, Reason, SatState*);  // set the literal at current level
+BOOLEAN literalSet(Lit*, SatState*);  // propagate an assigned literal
+BOOLEAN clauseTest(Clause*, Lit*, SatState*);
+BOOLEAN binaryTest(Lit*, SatState*);
+BOOLEAN ternaryTest(Lit*, SatState*);
+Clause* reasonOf(Lit*, SatState*);
+void clauseAttach(Clause*, SatState*);
+void clauseReserve(LitCode*, c2dSize, SatState*);
+void conflictFound(Clause*, SatState*);
+void learnedWatch(Clause*, SatState*);
 void conflictSet(Clause*, SatState*);  // conflict set method
 void firstUIP(Clause*, SatState*);  // 1-UIP method
+c2dSize learnedMinimize(Lit**, c2dSize, SatState*);
+BOOLEAN litRedundant(Lit*, c2dSize, SatState*);
+/******************************************************************************
+* learned clause database
+*******************************************************************************/
+Clause* learnedAdd(c2dSize, Lit**, SatState*);
+c2dSize clauseLbd(Clause*, SatState*);
+void clauseBump(Clause*, SatState*);
+void activityRescale(SatState*);
+BOOLEAN clauseLocked(Clause*, SatState*);
+int learnedCompare(const void*, const void*);
+void learnedReduce(SatState*);
 
 void literalUnset(Lit*, SatState*);
+void clauseSubsume(Clause*, SatState*);
+void clauseUnsubsume(Clause*, SatState*);
 /******************************************************************************
 * initialization function
 *******************************************************************************/
+SatState* stateNew(void);
+BOOLEAN loadFile(const char*, SatState*);
+void stateAlloc(SatState*);
+void stateClear(SatState*);
+void listsAlloc(SatState*);
 void parseFile(char*, SatState*);
-char* readFile(FILE *);
+void parseProblem(char**, SatState*);
+void deltaFit(c2dSize, SatState*);
+void occurPlace(c2dSize*, SatState*);
+void occurClose(c2dSize*, SatState*);
+void snapshotLoad(char*, c2dSize, SatState*);
+BOOLEAN snapshotValid(const char*, c2dSize);
+BOOLEAN snapshotSave(const SatState*, FILE*);
+c2dSize parseClauses(char*, LitCode*, c2dSize*, BOOLEAN, SatState*);
+char* mapFile(int, c2dSize*);
+void unmapFile(char*, c2dSize);
+char* readFile(FILE *, const unsigned char*, c2dSize, c2dSize*);
 void skipWhitespace(char**);
 void skipLine(char**);
 BOOLEAN getSign(char**);
 c2dSize parseNum(char**);
 
-void addClause(char**, SatState*, c2dSize);
-Lit* lit_new(c2dLiteral);
-void lit_addOccur(Lit*, Clause*);
-Var* var_new(c2dSize);
-Clause* clause_new(c2dSize, c2dSize, Lit**);
+void addClause(char**, LitCode*, c2dSize*, SatState*, c2dSize);
+c2dSize clauseRead(char**, LitCode*, SatState*);
+void clauseCount(LitCode*, c2dSize, c2dSize*, SatState*);
+Clause* clausePlace(c2dSize, c2dSize, LitCode*, c2dSize*, SatState*);
+Lit* lit_new(c2dLiteral, SatState*);
+void lit_addWatch(LitCode, Clause*, SatState*);
+void lit_addBinary(LitCode, LitCode, SatState*);
+void lit_addTernary(LitCode, LitCode, LitCode, Clause*, SatState*);
+void unitAdd(Clause*, SatState*);
+Var* var_new(c2dSize, SatState*);
+Clause* clause_new(c2dSize, c2dSize, Lit**, SatState*);
+Clause* clause_init(void*, c2dSize, c2dSize, Lit**, SatState*);
+Lit** clause_view(Clause*);
+void* arenaAlloc(c2dSize, SatState*);
+void arenaReserve(c2dSize, SatState*);
+void arenaFree(SatState*);
+/******************************************************************************
+* clauses given as codes
+*******************************************************************************/
+void storeInit(ClauseStore*);
+void storeReserve(ClauseStore*, c2dSize, c2dSize);
+void storeAdd(ClauseStore*, LitCode, SatState*);
+void storeClose(ClauseStore*, SatState*);
+void storeDrop(ClauseStore*, SatState*);
+void storeBuild(ClauseStore*, SatState*);
+void storeFree(ClauseStore*);
+/******************************************************************************
+* compressed input (stream.c)
+*******************************************************************************/
+Codec streamCodec(const unsigned char*, c2dSize);
+c2dSize streamLoad(FILE*, Codec, const unsigned char*, c2dSize, SatState*);
+void* streamDecode(void*);
+char* streamSlot(Stream*);
+void streamPush(Stream*, c2dSize);
+void streamEnd(Stream*, BOOLEAN);
+char* streamNext(Stream*, c2dSize*);
+void streamRelease(Stream*);
+c2dSize streamRead(Stream*, unsigned char*, c2dSize);
+BOOLEAN decodeGzip(Stream*, unsigned char*);
+BOOLEAN decodeXz(Stream*, unsigned char*);
+BOOLEAN decodeZstd(Stream*, unsigned char*);
+void streamParse(char*, TextParse*, SatState*);
+/******************************************************************************
+* preprocessing (preprocess.c)
+*******************************************************************************/
+BOOLEAN preprocess(SatState*, BOOLEAN);
+BOOLEAN substitute(SatState*);
+void prepInit(Prep*, BOOLEAN, SatState*);
+void prepFree(Prep*, SatState*);
+void prepFinish(Prep*, SatState*);
+c2dSize prepAdd(Prep*, SatState*);
+void prepRemove(Prep*, c2dSize);
+void prepStrengthen(Prep*, c2dSize, LitCode);
+void prepQueue(Prep*, c2dSize);
+void prepUnit(Prep*, LitCode);
+void prepTouch(Prep*, c2dSize);
+c2dSize prepOccurs(Prep*, LitCode);
+void prepGather(Prep*, LitCode);
+void prepAssign(Prep*, LitCode, SatState*);
+void prepPropagate(Prep*, SatState*);
+void prepBackward(Prep*, c2dSize, SatState*);
+void prepSubsume(Prep*, SatState*);
+void prepComponents(Prep*, SatState*);
+void prepEquivalences(Prep*, SatState*);
+void prepLearned(Prep*, Clause**, c2dSize, SatState*);
+c2dSize prepResolve(Prep*, c2dSize, c2dSize, LitCode);
+BOOLEAN prepGate(Prep*, LitCode, c2dSize, c2dSize);
+BOOLEAN prepEliminate(Prep*, c2dSize, SatState*);
+void prepElimination(Prep*, SatState*);
+int prepCompare(const void*, const void*);
+void occurAdd(OccurList*, c2dSize);
+void occurDelete(OccurList*, c2dSize);
+void elimPush(LitCode, SatState*);
+/******************************************************************************
+* probing (probe.c)
+*******************************************************************************/
+BOOLEAN probe(SatState*);
+c2dSize probeOrder(uint64_t*, SatState*);
+Clause* probeLiteral(Lit*, BOOLEAN, Probe*, SatState*);
+Clause* probeLearn(c2dSize, Lit**, SatState*);
+Clause* probeUnit(Lit*, SatState*);
+/******************************************************************************
+* backbone (backbone.c)
+*******************************************************************************/
+BOOLEAN backbone(Lit**, c2dSize*, SatState*);
+Clause* backboneSearch(Backbone*, SatState*);
+void backboneFilter(Backbone*, SatState*);
+/******************************************************************************
+* xor constraints (xor.c)
+*******************************************************************************/
+void xorDetect(SatState*);
+void xorGroup(XorGroup*, uint64_t, Clause*);
+int xorCompare(const void*, const void*);
+uint64_t xorParityMask(c2dSize, BOOLEAN);
+uint64_t xorMix(uint64_t);
+void xorEliminate(XorMatrix*);
+void xorFree(SatState*);
+c2dSize xorFirst(XorMatrix*, c2dSize, c2dSize, c2dSize, SatState*);
+BOOLEAN xorAssigned(XorMatrix*, c2dSize, SatState*);
+void xorAssign(LitCode, SatState*);
+void xorUnassign(LitCode, SatState*);
+void xorRowAdd(XorMatrix*, c2dSize, c2dSize);
+void xorTrim(XorMatrix*, c2dSize);
+BOOLEAN xorSet(Lit*, SatState*);
+void xorWatch(XorMatrix*, c2dSize, c2dSize, SatState*);
+BOOLEAN xorSettle(XorMatrix*, c2dSize, SatState*);
+Clause* xorExplain(XorMatrix*, c2dSize, c2dSize, Clause*, SatState*);
+Clause* xorClause(Clause*, c2dSize, c2dSize*);
+BOOLEAN xorUnits(SatState*);
+/******************************************************************************
+* at-most-one constraints (card.c)
+*******************************************************************************/
+c2dSize cardDetect(SatState*);
+void cardEdges(CardEdges*, SatState*);
+c2dSize cardClique(c2dSize, c2dSize*, c2dSize*, BOOLEAN*, CardEdges*, SatState*);
+void cardHit(c2dSize, c2dSize*, BOOLEAN*, CardEdges*);
+void cardSort(c2dSize*, c2dSize*, c2dSize);
+void cardFinish(BOOLEAN*, SatState*);
+void cardBuild(ClauseStore*, SatState*);
+BOOLEAN cardCovered(c2dSize, SatState*);
+void cardFree(SatState*);
+void cardAssign(LitCode, SatState*);
+void cardUnassign(LitCode, SatState*);
+BOOLEAN cardSet(Lit*, SatState*);
+void cardExpand(Prep*, SatState*);
+/******************************************************************************
+* decision order (order.c)
+*******************************************************************************/
+void orderAlloc(SatState*);
+void orderFree(SatState*);
+void heapUp(c2dSize, SatState*);
+void heapDown(c2dSize, SatState*);
+void heapInsert(c2dSize, SatState*);
+c2dSize heapPop(SatState*);
+void varBump(c2dSize, SatState*);
+void varDecay(SatState*);
+void varRescale(SatState*);
+Var* orderNext(SatState*);
+void orderSeed(c2dSize, SatState*);
+void phaseTarget(SatState*);
+/******************************************************************************
+* incremental solving (solve.c)
+*******************************************************************************/
+BOOLEAN solve(Lit**, c2dSize, BOOLEAN*, Lit**, c2dSize*, SatState*);
+void solveFailed(Lit*, Lit**, c2dSize*, SatState*);
+c2dSize lubyTerm(c2dSize);
+BOOLEAN clauseAdd(const c2dLiteral*, c2dSize, SatState*);
+BOOLEAN clauseImport(const c2dLiteral*, c2dSize, c2dSize, SatState*);
 /******************************************************************************
 * // print information for clause/literals
 *******************************************************************************/
@@ -0,0 +1,126 @@
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* backbone
+*
+* sat_backbone() finds a first model at level 1, whose literals (of the
+* variables mentioned by a clause not satisfied at level 1) are the
+* candidates, then checks each candidate left in turn, on the same sat state:
+* its opposite is decided at level 2, which unit resolution alone may refute
+* (a probe), else the search goes on below it
+* --a model found this way drops the candidates it does not share
+* --a refuted opposite teaches clauses that end up setting the candidate at
+*   level 1
+* the search takes the variables in the order of sat_next_decision(), and
+* decides those still candidates against their candidate literal, the others
+* in the phase it gives, so each model drops as many candidates as it can;
+* it restarts, back to the level it started from, after runs of RESTART_UNIT
+* times the terms of the luby sequence conflicts
+* the learned clauses are kept from one check to the next, and the literals
+* of the backbone are learned as unit clauses
+*******************************************************************************/
+/******************************************************************************
+* the whole computation, at level 1 once sat_unit_resolution() succeeded
+* returns 0 if the cnf is found unsatisfiable
+*******************************************************************************/
+BOOLEAN backbone(Lit** lits, c2dSize* count, SatState* sat_state) {
+  c2dSize i;
+  Backbone bb;
+  Lit* lit;
+  Clause* learned;
+  BOOLEAN sat = 1;
+
+  bb.model = (BOOLEAN*)calloc(sat_state->n+1, sizeof(BOOLEAN));
+  bb.value = (BOOLEAN*)calloc(sat_state->n+1, sizeof(BOOLEAN));
+  bb.candidate = (BOOLEAN*)calloc(sat_state->n+1, sizeof(BOOLEAN));
+  sat = backboneSearch(&bb, sat_state)==NULL;
+  for (i=0; i<sat_state->n && sat; i++) {
+    bb.candidate[i] = !sat_instantiated_var(sat_state->variables[i]) && sat_state->varUnsubsumed[i]>0;
+    bb.value[i] = bb.model[i];
+  }
+
+  for (i=0; i<sat_state->n && sat; i++) {
+    lit = bb.value[i] ? sat_state->variables[i]->pos : sat_state->variables[i]->neg;
+    while (bb.candidate[i] && !sat_implied_literal(lit)) {
+      learned = sat_decide_literal(lit->opp, sat_state);
+      if (learned==NULL)
+        learned = backboneSearch(&bb, sat_state);
+      sat_undo_decide_literal(sat_state);
+      if (learned==NULL)
+        backboneFilter(&bb, sat_state);
+      else if (sat_assertion_level(learned, sat_state)==0 || sat_assert_clause(learned, sat_state)!=NULL)
+        sat = 0; // the empty clause, or a conflict at level 1, which has no decision to undo
+    }
+  }
+
+  *count = 0;
+  for (i=0; i<sat_state->setCount && sat; i++) {
+    lit = sat_state->set[i];
+    if (REASON(lit, sat_state)==0 || REASON_IS_BINARY(REASON(lit, sat_state))
+        || ((Clause*)REASON(lit, sat_state))->size>1)
+      probeLearn(1, &lit, sat_state); // set again by sat_unit_resolution() from now on
+    lits[(*count)++] = lit;
+  }
+  free(bb.model);
+  free(bb.value);
+  free(bb.candidate);
+  return sat;
+}
+/******************************************************************************
+* backboneSearch :
+* the search of the sat solver, above the current level (the base): the
+* variables come from sat_next_decision(), a conflict backjumps to the
+* assertion level of the clause it learns and asserts it there, without
+* going below the base, and a restart goes back to the base
+* returns NULL when it sets every variable, the values are then in model,
+* else a learned clause that asserts below the base; either way the current
+* level is the base again
+*******************************************************************************/
+Clause* backboneSearch(Backbone* bb, SatState* sat_state) {
+  c2dSize i, level, base = sat_state->currentLevel, run = 0, runs = 0;
+  Lit* lit;
+  Clause* learned;
+
+  while (1) {
+    lit = sat_next_decision(sat_state);
+    if (lit==NULL) {
+      for (i=0; i<sat_state->n; i++)
+        bb->model[i] = sat_implied_literal(sat_state->variables[i]->pos);
+      sat_backtrack(base, sat_state);
+      return NULL;
+    }
+    i = lit->var->index-1;
+    if (bb->candidate[i] && runs==0)
+      lit = bb->value[i] ? lit->var->neg : lit->var->pos;
+    learned = sat_decide_literal(lit, sat_state);
+    while (learned!=NULL) {
+      run++;
+      level = sat_assertion_level(learned, sat_state);
+      if (level<base) {
+        sat_backtrack(base, sat_state);
+        return learned;
+      }
+      sat_backtrack(level, sat_state);
+      learned = sat_assert_clause(learned, sat_state);
+    }
+    if (run>=RESTART_UNIT*lubyTerm(runs+1)) {
+      runs++;
+      run = 0;
+      sat_backtrack(base, sat_state);
+    }
+  }
+}
+/******************************************************************************
+* the candidates a new model does not share are dropped
+*******************************************************************************/
+void backboneFilter(Backbone* bb, SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<sat_state->n; i++)
+    if (bb->model[i]!=bb->value[i])
+      bb->candidate[i] = 0;
+}
+/******************************************************************************
+ * end
+ ******************************************************************************/
@@ -0,0 +1,386 @@
+#include <time.h>
+
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* at-most-one constraints
+*
+* sat_cardinality() looks at the binary clauses of the cnf as the edges of a
+* graph over the literals: a clause (-a -b) says that a and b are not both
+* true. the cliques of this graph are the pairwise encodings of at-most-one
+* constraints, which take a quadratic number of binary clauses
+* --each literal, by decreasing degree, starts a clique, grown greedily by the
+*   neighbors it shares with all the literals already in it, through edges
+*   no clique took yet
+* --a clique of CARD_MIN_SIZE literals or more replaces its binary clauses by
+*   one constraint, an exactly-one when the cnf also has the clause of all its
+*   literals (that clause stays, one clause is cheap)
+* each constraint counts its literals set true and set false, kept by
+* literalAssign() and literalUnset(); a literal set true gives its constraints
+* to cardSet() through literalSet():
+* --another literal true already (more than one true): a conflict
+* --all the other literals false already: nothing to do
+* --else the other literals are set false
+* a literal set false this way has the binary clause of the two literals as
+* its reason, tagged like the reasons of binaryTest(), and spelled out by
+* reasonOf() only when conflict analysis asks for it
+* sat_preprocess() takes the constraints back apart into binary clauses, and
+* finds them again on the cnf it leaves
+*******************************************************************************/
+/******************************************************************************
+* the whole pass, the constraints found replace their binary clauses in the
+* cnf of the sat state
+* returns the number of constraints found
+*******************************************************************************/
+c2dSize cardDetect(SatState* sat_state) {
+  c2dSize i, j, k, x, size, first;
+  c2dSize count = 0;
+  c2dSize* degrees;
+  c2dSize* order;
+  c2dSize* hits;
+  c2dSize* members;
+  BOOLEAN* covered;
+  BOOLEAN* marks;
+  CardEdges edges;
+  ClauseStore constraints;
+  CardStats* stats = &sat_state->cardStats;
+  clock_t start = clock();
+
+  if (!CARD_DETECT || sat_state->m==0)
+    return 0;
+  cardEdges(&edges, sat_state);
+  degrees = (c2dSize*)malloc(sizeof(c2dSize)*(2*sat_state->n+1));
+  order = (c2dSize*)malloc(sizeof(c2dSize)*(2*sat_state->n+1));
+  hits = (c2dSize*)calloc(2*sat_state->n+1, sizeof(c2dSize));
+  edges.stamps = (c2dSize*)calloc(2*sat_state->n+1, sizeof(c2dSize));
+  edges.stamp = 0;
+  members = (c2dSize*)malloc(sizeof(c2dSize)*(2*sat_state->n+1));
+  marks = (BOOLEAN*)calloc(2*sat_state->n+1, sizeof(BOOLEAN));
+  covered = (BOOLEAN*)calloc(sat_state->m+1, sizeof(BOOLEAN));
+  for (i=0; i<2*sat_state->n; i++) {
+    degrees[i] = edges.starts[i+1]-edges.starts[i];
+    order[i] = i;
+  }
+  cardSort(order, degrees, 2*sat_state->n);
+  storeInit(&constraints);
+
+  for (i=0; i<2*sat_state->n; i++) {
+    x = order[i];
+    if (degrees[x]+1<CARD_MIN_SIZE)
+      break; // neither x nor those after it
+    size = cardClique(x, members, hits, covered, &edges, sat_state);
+    if (size>=CARD_MIN_SIZE) {
+      for (j=0; j<size; j++)
+        marks[members[j]] = 1;
+      for (j=0; j<size; j++) // the edges of the clique, duplicates included
+        for (k=edges.starts[members[j]]; k<edges.starts[members[j]+1]; k++)
+          if (marks[edges.others[k]] && !covered[edges.ids[k]]) {
+            covered[edges.ids[k]] = 1;
+            stats->binaries++;
+          }
+      for (j=0; j<size; j++) {
+        marks[members[j]] = 0;
+        storeAdd(&constraints, members[j], sat_state);
+      }
+      storeClose(&constraints, sat_state);
+      stats->literals += size;
+      count++;
+    }
+    for (j=0; j<size; j++) // back to 0, for the next clique
+      for (k=edges.starts[members[j]]; k<edges.starts[members[j]+1]; k++)
+        hits[edges.others[k]] = 0;
+  }
+  stats->groups += count;
+
+  if (count>0) {
+    first = sat_state->card!=NULL ? sat_state->card->count : 0;
+    cardFinish(covered, sat_state);
+    cardBuild(&constraints, sat_state);
+    for (i=first; i<sat_state->card->count; i++)
+      stats->exactlyOne += cardCovered(i, sat_state);
+  }
+  storeFree(&constraints);
+  free(edges.starts);
+  free(edges.others);
+  free(edges.ids);
+  free(edges.stamps);
+  free(degrees);
+  free(order);
+  free(hits);
+  free(members);
+  free(marks);
+  free(covered);
+  stats->time += ((double)(clock()-start))/CLOCKS_PER_SEC;
+  return count;
+}
+/******************************************************************************
+* the edges of the graph, from each literal to the literals it may not be
+* true with, with the index (0 based) of their binary clause
+*******************************************************************************/
+void cardEdges(CardEdges* edges, SatState* sat_state) {
+  c2dSize i, a, b;
+  c2dSize total = 0;
+  c2dSize* fill;
+  Clause* clause;
+
+  edges->starts = (c2dSize*)calloc(2*sat_state->n+1, sizeof(c2dSize));
+  for (i=0; i<sat_state->m; i++) {
+    clause = sat_state->delta[i];
+    if (clause->size!=2 || clause->codes[0]==(clause->codes[1]^1))
+      continue;
+    edges->starts[clause->codes[0]^1]++;
+    edges->starts[clause->codes[1]^1]++;
+    total += 2;
+  }
+  for (i=0, a=0; i<2*sat_state->n; i++) { // counts to starts
+    b = edges->starts[i];
+    edges->starts[i] = a;
+    a += b;
+  }
+  edges->starts[2*sat_state->n] = total;
+  edges->others = (LitCode*)malloc(sizeof(LitCode)*(total+1));
+  edges->ids = (c2dSize*)malloc(sizeof(c2dSize)*(total+1));
+  fill = (c2dSize*)malloc(sizeof(c2dSize)*(2*sat_state->n+1));
+  memcpy(fill, edges->starts, sizeof(c2dSize)*(2*sat_state->n+1));
+  for (i=0; i<sat_state->m; i++) {
+    clause = sat_state->delta[i];
+    if (clause->size!=2 || clause->codes[0]==(clause->codes[1]^1))
+      continue;
+    a = clause->codes[0]^1;
+    b = clause->codes[1]^1;
+    edges->others[fill[a]] = b;
+    edges->ids[fill[a]++] = i;
+    edges->others[fill[b]] = a;
+    edges->ids[fill[b]++] = i;
+  }
+  free(fill);
+}
+/******************************************************************************
+* cardClique :
+* a clique that x starts: its neighbors (through edges no clique took) are
+* taken in turn, each one that all the literals taken so far are neighbors of
+* joins; hits counts for each literal the literals taken it is a neighbor of
+* returns the size of the clique, whose literals are left in members
+*******************************************************************************/
+c2dSize cardClique(c2dSize x, c2dSize* members, c2dSize* hits, BOOLEAN* covered, CardEdges* edges, SatState* sat_state) {
+  c2dSize i, y;
+  c2dSize size = 0;
+
+  members[size++] = x;
+  cardHit(x, hits, covered, edges);
+  for (i=edges->starts[x]; i<edges->starts[x+1]; i++) {
+    y = edges->others[i];
+    if (covered[edges->ids[i]] || hits[y]!=size)
+      continue;
+    members[size++] = y;
+    cardHit(y, hits, covered, edges);
+  }
+  return size;
+}
+void cardHit(c2dSize x, c2dSize* hits, BOOLEAN* covered, CardEdges* edges) {
+  c2dSize i;
+
+  edges->stamp++;
+  for (i=edges->starts[x]; i<edges->starts[x+1]; i++)
+    if (!covered[edges->ids[i]] && edges->stamps[edges->others[i]]!=edges->stamp) {
+      hits[edges->others[i]]++;
+      edges->stamps[edges->others[i]] = edges->stamp; // once, whatever the duplicate clauses
+    }
+}
+/******************************************************************************
+* the literals by decreasing degree, as probeOrder() sorts its variables
+*******************************************************************************/
+void cardSort(c2dSize* order, c2dSize* degrees, c2dSize count) {
+  c2dSize i;
+  uint64_t* keys = (uint64_t*)malloc(sizeof(uint64_t)*(count+1));
+
+  for (i=0; i<count; i++)
+    keys[i] = ((uint64_t)(0xffffffff-(degrees[i]<0xffffffff ? degrees[i] : 0xffffffff))<<32) | order[i];
+  qsort(keys, count, sizeof(uint64_t), prepCompare);
+  for (i=0; i<count; i++)
+    order[i] = keys[i] & 0xffffffff;
+  free(keys);
+}
+/******************************************************************************
+* the cnf clauses that no constraint covers replace the cnf of the sat state,
+* placed as prepFinish() places them
+*******************************************************************************/
+void cardFinish(BOOLEAN* covered, SatState* sat_state) {
+  c2dSize i, j;
+  ClauseStore store;
+  Clause* clause;
+
+  storeInit(&store);
+  for (i=0; i<sat_state->m; i++) {
+    if (covered[i])
+      continue;
+    clause = sat_state->delta[i];
+    for (j=0; j<clause->size; j++)
+      storeAdd(&store, clause->codes[j], sat_state);
+    storeClose(&store, sat_state);
+  }
+  stateClear(sat_state);
+  sat_state->m = store.count;
+  storeBuild(&store, sat_state);
+  storeFree(&store);
+  xorDetect(sat_state);
+}
+/******************************************************************************
+* the constraints of a store become those of the sat state, after any it had
+******************************************************************************/
+void cardBuild(ClauseStore* store, SatState* sat_state) {
+  c2dSize i, j, first;
+  Card* card = sat_state->card;
+
+  if (card==NULL) {
+    card = (Card*)calloc(1, sizeof(Card));
+    card->starts = (c2dSize*)calloc(1, sizeof(c2dSize));
+    card->lists = (OccurList*)calloc(2*sat_state->n, sizeof(OccurList));
+    sat_state->card = card;
+  }
+  first = card->count;
+  card->count += store->count;
+  card->starts = (c2dSize*)realloc(card->starts, sizeof(c2dSize)*(card->count+1));
+  card->codes = (LitCode*)realloc(card->codes, sizeof(LitCode)*(card->starts[first]+store->starts[store->count]+1));
+  card->trues = (c2dSize*)realloc(card->trues, sizeof(c2dSize)*card->count);
+  card->falses = (c2dSize*)realloc(card->falses, sizeof(c2dSize)*card->count);
+  for (i=0; i<store->count; i++) {
+    card->starts[first+i+1] = card->starts[first+i]+store->starts[i+1]-store->starts[i];
+    card->trues[first+i] = 0;
+    card->falses[first+i] = 0;
+    for (j=store->starts[i]; j<store->starts[i+1]; j++) {
+      card->codes[card->starts[first]+j] = store->codes[j];
+      occurAdd(&card->lists[store->codes[j]], first+i);
+    }
+  }
+}
+/******************************************************************************
+* 1 if the cnf has the clause of all the literals of a constraint, which is
+* then an exactly-one
+*******************************************************************************/
+BOOLEAN cardCovered(c2dSize c, SatState* sat_state) {
+  c2dSize i, j;
+  Card* card = sat_state->card;
+  c2dSize size = card->starts[c+1]-card->starts[c];
+  Lit* lit = &sat_state->literals[card->codes[card->starts[c]]];
+  Clause* clause;
+  BOOLEAN found = 0;
+
+  for (i=card->starts[c]; i<card->starts[c+1]; i++)
+    sat_state->litSeen[card->codes[i]] = 1;
+  for (i=0; i<lit->occurSize && !found; i++) {
+    clause = lit->occurIn[i];
+    if (clause->size!=size)
+      continue;
+    for (j=0; j<size && sat_state->litSeen[clause->codes[j]]; j++);
+    found = j==size;
+  }
+  for (i=card->starts[c]; i<card->starts[c+1]; i++)
+    sat_state->litSeen[card->codes[i]] = 0;
+  return found;
+}
+void cardFree(SatState* sat_state) {
+  c2dSize i;
+  Card* card = sat_state->card;
+
+  if (card==NULL)
+    return;
+  for (i=0; i<2*sat_state->n; i++)
+    free(card->lists[i].ids);
+  free(card->lists);
+  free(card->starts);
+  free(card->codes);
+  free(card->trues);
+  free(card->falses);
+  free(card);
+  sat_state->card = NULL;
+  sat_state->cardStats.groups = 0; // those found again count again
+  sat_state->cardStats.exactlyOne = 0;
+  sat_state->cardStats.literals = 0;
+  sat_state->cardStats.binaries = 0;
+}
+/******************************************************************************
+* cardAssign, cardUnassign :
+* the counters of the constraints of a literal set or unset, and of its
+* opposite, follow literalAssign() and literalUnset()
+*******************************************************************************/
+void cardAssign(LitCode code, SatState* sat_state) {
+  c2dSize i;
+  Card* card = sat_state->card;
+  OccurList* list = &card->lists[code];
+
+  for (i=0; i<list->size; i++)
+    card->trues[list->ids[i]]++;
+  list = &card->lists[code^1];
+  for (i=0; i<list->size; i++)
+    card->falses[list->ids[i]]++;
+}
+void cardUnassign(LitCode code, SatState* sat_state) {
+  c2dSize i;
+  Card* card = sat_state->card;
+  OccurList* list = &card->lists[code];
+
+  for (i=0; i<list->size; i++)
+    card->trues[list->ids[i]]--;
+  list = &card->lists[code^1];
+  for (i=0; i<list->size; i++)
+    card->falses[list->ids[i]]--;
+}
+/******************************************************************************
+* cardSet :
+* lit was set true, the other literals of its constraints are set false; its
+* counter already has lit, so more than one literal true is a conflict, and
+* only then is the other one looked for, to spell out the conflict clause
+* returns 0 on a conflict, which stands for the binary clause in
+* sat_state->binaryConflict
+*******************************************************************************/
+BOOLEAN cardSet(Lit* lit, SatState* sat_state) {
+  c2dSize i, j, c;
+  LitCode other;
+  Card* card = sat_state->card;
+  OccurList* list = &card->lists[lit->code];
+  const c2dSize* level = sat_state->litLevel;
+
+  for (i=0; i<list->size; i++) {
+    c = list->ids[i];
+    if (card->trues[c]>1) { // a conflict clause, with the other literal true
+      for (j=card->starts[c]; card->codes[j]==lit->code || level[card->codes[j]]==0; j++);
+      sat_state->binaryConflict->codes[0] = lit->code^1;
+      sat_state->binaryConflict->codes[1] = card->codes[j]^1;
+      sat_state->cardStats.conflicts++;
+      sat_state->conflict = 1;
+      conflictFound(sat_state->binaryConflict, sat_state);
+      return 0;
+    }
+    if (card->falses[c]+1==card->starts[c+1]-card->starts[c])
+      continue; // the others are false
+    for (j=card->starts[c]; j<card->starts[c+1]; j++) {
+      other = card->codes[j];
+      if (other==lit->code || level[other^1]>0)
+        continue;
+      literalAssign(&sat_state->literals[other^1], REASON_BINARY(lit->code^1), sat_state);
+      sat_state->cardStats.implied++;
+    }
+  }
+  return 1;
+}
+/******************************************************************************
+* the binary clauses of the constraints, which the cnf had before, become
+* clauses of prep (see prepInit())
+*******************************************************************************/
+void cardExpand(Prep* prep, SatState* sat_state) {
+  c2dSize c, i, j;
+  Card* card = sat_state->card;
+
+  for (c=0; c<card->count; c++)
+    for (i=card->starts[c]; i<card->starts[c+1]; i++)
+      for (j=i+1; j<card->starts[c+1]; j++) {
+        storeAdd(&prep->store, card->codes[i]^1, sat_state);
+        storeAdd(&prep->store, card->codes[j]^1, sat_state);
+        prepAdd(prep, sat_state);
+      }
+}
+/******************************************************************************
+ * end
+ ******************************************************************************/
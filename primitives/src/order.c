@@ -0,0 +1,193 @@
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* decision order
+*
+* each variable has an activity, bumped when conflict analysis meets one of
+* its literals, and the amount of a bump grows by 1/VAR_DECAY after each
+* conflict, so older bumps count less and less (EVSIDS)
+* the variables are kept in a binary heap by activity, the highest first and
+* the lower index first among equal ones (so, before any conflict, the order
+* is the order of the indexes)
+* a variable set stays in the heap until sat_next_decision() finds it on top,
+* and is put back when it is unset, so the heap holds every free variable
+*
+* the literal decided for the variable follows the phase of the sat state
+* (PHASE unless sat_set_phase() changed it):
+* --the saved phase of a variable is its last value, kept by literalUnset()
+* --the target phase is its value in the target trail, the largest trail seen
+*   by sat_decide_literal() (so, one unit resolution left without conflict),
+*   the search goes back to that partial assignment after it backtracks
+*   instead of finding it again, and tries to extend it; the variables never
+*   in the target trail keep the first phase, positive
+*******************************************************************************/
+/******************************************************************************
+* the heap over all the variables, once n is known
+*******************************************************************************/
+void orderAlloc(SatState* sat_state) {
+  c2dSize i;
+
+  sat_state->varActivity = (double*)calloc(sat_state->n+1, sizeof(double));
+  sat_state->heap = (c2dSize*)malloc(sizeof(c2dSize)*(sat_state->n+1));
+  sat_state->heapPos = (c2dSize*)malloc(sizeof(c2dSize)*(sat_state->n+1));
+  for (i=0; i<sat_state->n; i++) { // all at 0, by index is already a heap
+    sat_state->heap[i] = i;
+    sat_state->heapPos[i] = i;
+  }
+  sat_state->heapSize = sat_state->n;
+  sat_state->varInc = 1;
+  sat_state->phase = PHASE;
+  sat_state->varPhase = (BOOLEAN*)malloc(sizeof(BOOLEAN)*(sat_state->n+1));
+  sat_state->varTarget = (BOOLEAN*)malloc(sizeof(BOOLEAN)*(sat_state->n+1));
+  memset(sat_state->varPhase, 1, sizeof(BOOLEAN)*(sat_state->n+1));
+  memset(sat_state->varTarget, 1, sizeof(BOOLEAN)*(sat_state->n+1));
+  sat_state->targetSize = 0;
+  sat_state->targetSame = 0;
+}
+void orderFree(SatState* sat_state) {
+  free(sat_state->varActivity);
+  free(sat_state->heap);
+  free(sat_state->heapPos);
+  free(sat_state->varPhase);
+  free(sat_state->varTarget);
+}
+/******************************************************************************
+* heapUp, heapDown :
+* move the variable at place i of the heap up or down to where it belongs
+*******************************************************************************/
+void heapUp(c2dSize i, SatState* sat_state) {
+  c2dSize* heap = sat_state->heap;
+  c2dSize var = heap[i];
+
+  while (i>0 && HEAP_BEFORE(var, heap[(i-1)/2], sat_state)) {
+    heap[i] = heap[(i-1)/2];
+    sat_state->heapPos[heap[i]] = i;
+    i = (i-1)/2;
+  }
+  heap[i] = var;
+  sat_state->heapPos[var] = i;
+}
+void heapDown(c2dSize i, SatState* sat_state) {
+  c2dSize child;
+  c2dSize* heap = sat_state->heap;
+  c2dSize var = heap[i];
+
+  while ((child = 2*i+1)<sat_state->heapSize) {
+    if (child+1<sat_state->heapSize && HEAP_BEFORE(heap[child+1], heap[child], sat_state))
+      child++;
+    if (!HEAP_BEFORE(heap[child], var, sat_state))
+      break;
+    heap[i] = heap[child];
+    sat_state->heapPos[heap[i]] = i;
+    i = child;
+  }
+  heap[i] = var;
+  sat_state->heapPos[var] = i;
+}
+/******************************************************************************
+* heapInsert, heapPop :
+* put a variable (index-1) that is not in the heap back in it, take out the
+* one with the highest activity
+*******************************************************************************/
+void heapInsert(c2dSize var, SatState* sat_state) {
+  ASSERT_TEST(sat_state->heapPos[var]==HEAP_NONE);
+  sat_state->heap[sat_state->heapSize] = var;
+  heapUp(sat_state->heapSize++, sat_state);
+}
+c2dSize heapPop(SatState* sat_state) {
+  c2dSize var = sat_state->heap[0];
+
+  sat_state->heapPos[var] = HEAP_NONE;
+  if (--sat_state->heapSize>0) {
+    sat_state->heap[0] = sat_state->heap[sat_state->heapSize];
+    heapDown(0, sat_state);
+  }
+  return var;
+}
+/******************************************************************************
+* varBump :
+* a literal of the variable (index-1) took part in conflict analysis
+*******************************************************************************/
+void varBump(c2dSize var, SatState* sat_state) {
+  if ((sat_state->varActivity[var] += sat_state->varInc)>1e100)
+    varRescale(sat_state);
+  if (sat_state->heapPos[var]!=HEAP_NONE)
+    heapUp(sat_state->heapPos[var], sat_state);
+}
+/******************************************************************************
+* varDecay :
+* after a conflict, the next bumps count more than the ones before
+*******************************************************************************/
+void varDecay(SatState* sat_state) {
+  sat_state->varInc /= VAR_DECAY;
+  if (sat_state->varInc>1e100)
+    varRescale(sat_state);
+}
+/******************************************************************************
+* varRescale :
+* scale all variable activities down before they overflow, the order stays
+*******************************************************************************/
+void varRescale(SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<sat_state->n; i++)
+    sat_state->varActivity[i] *= 1e-100;
+  sat_state->varInc *= 1e-100;
+}
+/******************************************************************************
+* orderNext :
+* the free variable with the highest activity, NULL once every variable is set
+* the variables set on top of the heap are popped, the one found stays in it
+* until it is set as well
+*******************************************************************************/
+Var* orderNext(SatState* sat_state) {
+  c2dSize var;
+
+  while (sat_state->heapSize>0) {
+    var = sat_state->heap[0];
+    if (sat_state->litLevel[2*var]==0 && sat_state->litLevel[2*var+1]==0)
+      return sat_state->variables[var];
+    heapPop(sat_state);
+  }
+  return NULL;
+}
+/******************************************************************************
+* orderSeed :
+* random activities below 1 (the first bump) for all the variables, from a
+* xorshift generator started by seed, then the heap is built again; they
+* only change the order among the variables no conflict has bumped yet
+* seed 0 sets them all to 0
+*******************************************************************************/
+void orderSeed(c2dSize seed, SatState* sat_state) {
+  c2dSize i;
+  uint64_t state = (seed*0x9E3779B97F4A7C15ULL)|1; // never 0
+
+  for (i=0; i<sat_state->n; i++) {
+    state ^= state<<13;
+    state ^= state>>7;
+    state ^= state<<17;
+    sat_state->varActivity[i] = seed==0 ? 0 : (double)(state>>11)/9007199254740992.0; // in [0,1)
+  }
+  for (i=sat_state->heapSize/2; i>0; i--)
+    heapDown(i-1, sat_state);
+}
+/******************************************************************************
+* phaseTarget :
+* the trail is larger than the target trail, it becomes the target trail
+* only its literals past targetSame changed since the last time
+*******************************************************************************/
+void phaseTarget(SatState* sat_state) {
+  c2dSize i;
+  LitCode code;
+
+  for (i=sat_state->targetSame; i<sat_state->setCount; i++) {
+    code = sat_state->set[i]->code;
+    sat_state->varTarget[code>>1] = !(code&1);
+  }
+  sat_state->targetSize = sat_state->setCount;
+  sat_state->targetSame = sat_state->setCount;
+}
+/******************************************************************************
+ * end
+ ******************************************************************************/
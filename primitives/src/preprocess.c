@@ -0,0 +1,895 @@
+#include <time.h>
+
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* preprocessing
+*
+* sat_preprocess() copies the cnf clauses into a Prep, simplifies them there
+* and places what is left back in the sat state:
+* --equivalent literals: the literals of a strongly connected component of
+*   the binary implication graph are all replaced by the one of them with
+*   the least variable, see sat_substitute_equivalences() to do only this
+* --a unit clause sets its literal, the clauses with the literal are removed
+*   and the opposite literal is removed from the others
+* --backward subsumption: a clause removes the clauses it subsumes, and
+*   strengthens the clauses it subsumes but for one literal that it has the
+*   other way around (self-subsuming resolution)
+* --bounded variable elimination: the clauses of a variable are replaced by
+*   their resolvents on it, when these are no more than the clauses. when
+*   some of its clauses define the variable as a gate of other literals, only
+*   the resolvents of a gate clause with another clause are needed
+* sat_preprocess_count() only eliminates the variables defined by a gate,
+* which like the variables set by unit clauses are determined by the others:
+* the cnf left gets a unit clause for each, so it has the models of the cnf
+* it was given but for their values, and as many
+* a clause that changes is queued for backward subsumption and touches its
+* variables, which are then tried for elimination (again)
+* the clauses that decide the value of a variable set, substituted or
+* eliminated go on the elimination stack of the sat state, for sat_extend_model()
+*******************************************************************************/
+/******************************************************************************
+* the whole pipeline, keeping the model count when count is 1
+* returns 0 if the cnf is found unsatisfiable, the cnf of the sat state,
+* its elimination stack and its determined variables are then left as
+* they were
+*******************************************************************************/
+BOOLEAN preprocess(SatState* sat_state, BOOLEAN count) {
+  Prep prep;
+  c2dSize i;
+  BOOLEAN sat;
+  c2dSize elimSize = sat_state->elimSize;
+  c2dSize determined = sat_state->determined;
+  PrepStats* stats = &sat_state->prepStats;
+  clock_t start = clock();
+
+  stats->clausesBefore = sat_state->m;
+  stats->varsBefore = 0;
+  for (i=0; i<2*sat_state->n; i+=2)
+    stats->varsBefore += sat_state->literals[i].occurSize+sat_state->literals[i+1].occurSize>0;
+  prepInit(&prep, count, sat_state);
+  prepEquivalences(&prep, sat_state);
+  prepSubsume(&prep, sat_state);
+  prepElimination(&prep, sat_state);
+  sat = !prep.unsat;
+  if (sat)
+    prepFinish(&prep, sat_state);
+  else {
+    sat_state->elimSize = elimSize;
+    sat_state->determined = determined;
+  }
+  stats->clausesAfter = sat_state->m;
+  stats->varsAfter = 0;
+  for (i=0; i<2*sat_state->n; i+=2)
+    stats->varsAfter += sat_state->literals[i].occurSize+sat_state->literals[i+1].occurSize>0;
+  prepFree(&prep, sat_state);
+  stats->time += ((double)(clock()-start))/CLOCKS_PER_SEC;
+  return sat;
+}
+/******************************************************************************
+* equivalent literals and the unit clauses they leave only, keeping the
+* learned clauses, which are rewritten the same way
+* returns 0 if the cnf is found unsatisfiable, the cnf of the sat state and
+* its elimination stack are then left as they were
+*******************************************************************************/
+BOOLEAN substitute(SatState* sat_state) {
+  Prep prep;
+  BOOLEAN sat;
+  c2dSize elimSize = sat_state->elimSize;
+  c2dSize count = sat_state->l;
+  Clause** learned = (Clause**)malloc(sizeof(Clause*)*(count+1));
+  clock_t start = clock();
+
+  prepInit(&prep, 0, sat_state);
+  prepEquivalences(&prep, sat_state);
+  prepPropagate(&prep, sat_state);
+  sat = !prep.unsat;
+  if (!sat)
+    sat_state->elimSize = elimSize;
+  else if (sat_state->elimSize>elimSize) { // some variable was substituted or set
+    memcpy(learned, sat_state->delta+sat_state->m, sizeof(Clause*)*count);
+    sat_state->l = 0;
+    prepFinish(&prep, sat_state);
+    prepLearned(&prep, learned, count, sat_state);
+  }
+  prepFree(&prep, sat_state);
+  free(learned);
+  sat_state->prepStats.time += ((double)(clock()-start))/CLOCKS_PER_SEC;
+  return sat;
+}
+/******************************************************************************
+* prepInit, prepFree :
+* the cnf clauses of the sat state, without tautologies, all queued for
+* backward subsumption and all their variables touched
+*******************************************************************************/
+void prepInit(Prep* prep, BOOLEAN count, SatState* sat_state) {
+  c2dSize i, j, total = 0;
+  Clause* clause;
+  BOOLEAN tautology;
+
+  prep->clauseCap = sat_state->m>0 ? sat_state->m : 1;
+  prep->sizes = (c2dSize*)malloc(sizeof(c2dSize)*prep->clauseCap);
+  prep->signs = (uint64_t*)malloc(sizeof(uint64_t)*prep->clauseCap);
+  prep->removed = (BOOLEAN*)malloc(sizeof(BOOLEAN)*prep->clauseCap);
+  prep->queued = (BOOLEAN*)malloc(sizeof(BOOLEAN)*prep->clauseCap);
+  prep->queueCap = prep->clauseCap;
+  prep->queue = (c2dSize*)malloc(sizeof(c2dSize)*prep->queueCap);
+  prep->queueSize = 0;
+  prep->occurs = (OccurList*)calloc(2*sat_state->n, sizeof(OccurList));
+  prep->counts = (c2dSize*)calloc(2*sat_state->n, sizeof(c2dSize));
+  prep->marks = (BOOLEAN*)calloc(2*sat_state->n, sizeof(BOOLEAN));
+  prep->value = (BOOLEAN*)calloc(2*sat_state->n, sizeof(BOOLEAN));
+  prep->repr = (LitCode*)malloc(sizeof(LitCode)*(2*sat_state->n+1));
+  for (i=0; i<2*sat_state->n; i++)
+    prep->repr[i] = i;
+  prep->unitCap = 16;
+  prep->units = (LitCode*)malloc(sizeof(LitCode)*prep->unitCap);
+  prep->unitHead = 0;
+  prep->unitCount = 0;
+  prep->gone = (BOOLEAN*)calloc(sat_state->n, sizeof(BOOLEAN));
+  prep->touched = (BOOLEAN*)calloc(sat_state->n, sizeof(BOOLEAN));
+  prep->touchList = (c2dSize*)malloc(sizeof(c2dSize)*(sat_state->n+1));
+  prep->touchCount = 0;
+  prep->idCap = 16;
+  prep->ids = (c2dSize*)malloc(sizeof(c2dSize)*prep->idCap);
+  prep->gate = (BOOLEAN*)malloc(sizeof(BOOLEAN)*prep->idCap);
+  prep->buffer = (LitCode*)malloc(sizeof(LitCode)*(sat_state->n+1));
+  prep->steps = 0;
+  prep->count = count;
+  prep->unsat = 0;
+
+  for (i=0; i<2*sat_state->n; i++) { // lists at the size they have in the sat state
+    prep->occurs[i].cap = sat_state->literals[i].occurSize;
+    if (prep->occurs[i].cap>0)
+      prep->occurs[i].ids = (c2dSize*)malloc(sizeof(c2dSize)*prep->occurs[i].cap);
+  }
+  storeInit(&prep->store);
+  for (i=0; i<sat_state->m; i++)
+    total += sat_state->delta[i]->size;
+  storeReserve(&prep->store, sat_state->m, total);
+  for (i=0; i<sat_state->m; i++) {
+    clause = sat_state->delta[i];
+    tautology = 0;
+    for (j=0; j<clause->size; j++) {
+      tautology |= sat_state->litSeen[clause->codes[j]^1]; // set by storeAdd() for the open clause
+      storeAdd(&prep->store, clause->codes[j], sat_state);
+    }
+    if (tautology)
+      storeDrop(&prep->store, sat_state); // satisfied by any model
+    else
+      prepAdd(prep, sat_state);
+  }
+  prep->card = sat_state->card!=NULL;
+  if (prep->card)
+    cardExpand(prep, sat_state); // their binary clauses, like those of the cnf
+}
+void prepFree(Prep* prep, SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<2*sat_state->n; i++)
+    free(prep->occurs[i].ids);
+  free(prep->occurs);
+  storeFree(&prep->store);
+  free(prep->sizes);
+  free(prep->signs);
+  free(prep->removed);
+  free(prep->queued);
+  free(prep->queue);
+  free(prep->counts);
+  free(prep->marks);
+  free(prep->value);
+  free(prep->repr);
+  free(prep->units);
+  free(prep->gone);
+  free(prep->touched);
+  free(prep->touchList);
+  free(prep->ids);
+  free(prep->gate);
+  free(prep->buffer);
+}
+/******************************************************************************
+* the clauses left replace the cnf of the sat state, placed as the builder
+* of sat_api.h places its clauses, then when keeping the model count the
+* unit clauses of the determined variables (an eliminated variable is set
+* false, any value would do)
+*******************************************************************************/
+void prepFinish(Prep* prep, SatState* sat_state) {
+  c2dSize i, j;
+  ClauseStore store;
+  LitCode* codes;
+
+  storeInit(&store);
+  for (i=0; i<prep->store.count; i++) {
+    if (prep->removed[i])
+      continue;
+    codes = prep->store.codes+prep->store.starts[i];
+    for (j=0; j<prep->sizes[i]; j++)
+      storeAdd(&store, codes[j], sat_state);
+    storeClose(&store, sat_state);
+  }
+  for (i=0; i<sat_state->n && prep->count; i++)
+    if (prep->gone[i]) {
+      storeAdd(&store, prep->value[2*i] ? 2*i : 2*i+1, sat_state);
+      storeClose(&store, sat_state);
+    }
+  cardFree(sat_state);
+  stateClear(sat_state);
+  sat_state->m = store.count;
+  storeBuild(&store, sat_state);
+  storeFree(&store);
+  xorDetect(sat_state); // the rows of the cnf left
+  if (prep->card)
+    cardDetect(sat_state);
+}
+/******************************************************************************
+* prepAdd :
+* the clause open in the store of prep becomes one of its clauses
+* returns its id, its position in the store
+*******************************************************************************/
+c2dSize prepAdd(Prep* prep, SatState* sat_state) {
+  c2dSize i;
+  c2dSize id = prep->store.count;
+  c2dSize size;
+  LitCode* codes;
+
+  storeClose(&prep->store, sat_state);
+  if (id==prep->clauseCap) {
+    prep->clauseCap *= 2;
+    prep->sizes = realloc(prep->sizes, sizeof(c2dSize)*prep->clauseCap);
+    prep->signs = realloc(prep->signs, sizeof(uint64_t)*prep->clauseCap);
+    prep->removed = realloc(prep->removed, sizeof(BOOLEAN)*prep->clauseCap);
+    prep->queued = realloc(prep->queued, sizeof(BOOLEAN)*prep->clauseCap);
+  }
+  codes = prep->store.codes+prep->store.starts[id];
+  size = prep->store.starts[id+1]-prep->store.starts[id];
+  prep->sizes[id] = size;
+  prep->signs[id] = 0;
+  prep->removed[id] = 0;
+  prep->queued[id] = 0;
+  for (i=0; i<size; i++) {
+    prep->signs[id] |= PREP_SIGN(codes[i]);
+    occurAdd(&prep->occurs[codes[i]], id);
+    prep->counts[codes[i]]++;
+    prepTouch(prep, codes[i]>>1);
+  }
+  if (size==0)
+    prep->unsat = 1;
+  else if (size==1)
+    prepUnit(prep, codes[0]);
+  prepQueue(prep, id);
+  return id;
+}
+/******************************************************************************
+* prepRemove, prepStrengthen :
+* a clause is removed, or loses one of its literals
+* the clause stays in the occurrence lists of its literals when removed,
+* prepOccurs() drops it from there
+*******************************************************************************/
+void prepRemove(Prep* prep, c2dSize id) {
+  c2dSize i;
+  LitCode* codes = prep->store.codes+prep->store.starts[id];
+
+  prep->removed[id] = 1;
+  for (i=0; i<prep->sizes[id]; i++) {
+    prep->counts[codes[i]]--;
+    prepTouch(prep, codes[i]>>1);
+  }
+}
+void prepStrengthen(Prep* prep, c2dSize id, LitCode code) {
+  c2dSize i;
+  LitCode* codes = prep->store.codes+prep->store.starts[id];
+  c2dSize size = prep->sizes[id];
+
+  for (i=0; codes[i]!=code; i++)
+    ;
+  codes[i] = codes[--size];
+  prep->sizes[id] = size;
+  occurDelete(&prep->occurs[code], id);
+  prep->counts[code]--;
+  prepTouch(prep, code>>1);
+  prep->signs[id] = 0;
+  for (i=0; i<size; i++)
+    prep->signs[id] |= PREP_SIGN(codes[i]);
+  if (size==0)
+    prep->unsat = 1;
+  else if (size==1)
+    prepUnit(prep, codes[0]);
+  prepQueue(prep, id);
+}
+/******************************************************************************
+* prepQueue, prepUnit, prepTouch :
+* a clause to check for backward subsumption, a literal to set, a variable
+* to try for elimination
+*******************************************************************************/
+void prepQueue(Prep* prep, c2dSize id) {
+  if (prep->queued[id])
+    return;
+  if (prep->queueSize==prep->queueCap) {
+    prep->queueCap *= 2;
+    prep->queue = realloc(prep->queue, sizeof(c2dSize)*prep->queueCap);
+  }
+  prep->queue[prep->queueSize++] = id;
+  prep->queued[id] = 1;
+}
+void prepUnit(Prep* prep, LitCode code) {
+  if (prep->unitCount==prep->unitCap) {
+    prep->unitCap *= 2;
+    prep->units = realloc(prep->units, sizeof(LitCode)*prep->unitCap);
+  }
+  prep->units[prep->unitCount++] = code;
+}
+void prepTouch(Prep* prep, c2dSize var) {
+  if (prep->touched[var] || prep->gone[var])
+    return;
+  prep->touched[var] = 1;
+  prep->touchList[prep->touchCount++] = var;
+}
+/******************************************************************************
+* the occurrence list of a literal without its removed clauses
+* returns the number of clauses left in it
+*******************************************************************************/
+c2dSize prepOccurs(Prep* prep, LitCode code) {
+  c2dSize i, j = 0;
+  OccurList* list = &prep->occurs[code];
+
+  for (i=0; i<list->size; i++)
+    if (!prep->removed[list->ids[i]])
+      list->ids[j++] = list->ids[i];
+  list->size = j;
+  prep->steps += i;
+  return j;
+}
+/******************************************************************************
+* the clauses of the literal code then those of its opposite, copied to ids
+* since the lists change while the clauses are visited
+*******************************************************************************/
+void prepGather(Prep* prep, LitCode code) {
+  c2dSize i, j = 0;
+  OccurList* pos = &prep->occurs[code];
+  OccurList* neg = &prep->occurs[code^1];
+
+  if (pos->size+neg->size>prep->idCap) {
+    prep->idCap = pos->size+neg->size;
+    prep->ids = realloc(prep->ids, sizeof(c2dSize)*prep->idCap);
+    prep->gate = realloc(prep->gate, sizeof(BOOLEAN)*prep->idCap);
+  }
+  for (i=0; i<pos->size; i++)
+    prep->ids[j++] = pos->ids[i];
+  for (i=0; i<neg->size; i++)
+    prep->ids[j++] = neg->ids[i];
+}
+/******************************************************************************
+* prepAssign, prepPropagate :
+* set the literals of the unit clauses, until there are none left or a
+* literal is set both ways
+*******************************************************************************/
+void prepAssign(Prep* prep, LitCode code, SatState* sat_state) {
+  c2dSize i, id;
+  OccurList* list;
+
+  prep->value[code] = 1;
+  prep->gone[code>>1] = 1;
+  sat_state->prepStats.fixed++;
+  sat_state->determined += prep->count;
+  elimPush(code, sat_state);
+  elimPush(1, sat_state);
+  list = &prep->occurs[code];
+  for (i=0; i<list->size; i++)
+    if (!prep->removed[list->ids[i]])
+      prepRemove(prep, list->ids[i]);
+  list->size = 0;
+  list = &prep->occurs[code^1];
+  while (list->size>0 && !prep->unsat) { // each strengthening takes the last one out
+    id = list->ids[list->size-1];
+    if (prep->removed[id])
+      list->size--;
+    else
+      prepStrengthen(prep, id, code^1);
+  }
+}
+void prepPropagate(Prep* prep, SatState* sat_state) {
+  LitCode code;
+
+  while (!prep->unsat && prep->unitHead<prep->unitCount) {
+    code = prep->units[prep->unitHead++];
+    if (prep->value[code])
+      continue;
+    if (prep->value[code^1])
+      prep->unsat = 1;
+    else if (!prep->gone[code>>1]) // not eliminated since
+      prepAssign(prep, code, sat_state);
+  }
+}
+/******************************************************************************
+* prepBackward :
+* the clauses subsumed by a clause are removed, and those it subsumes but
+* for one literal it has the other way around lose that literal
+* they all mention the variable of the clause with the fewest clauses, so
+* only the clauses of that variable are checked
+*******************************************************************************/
+void prepBackward(Prep* prep, c2dSize id, SatState* sat_state) {
+  c2dSize i, j, count, d;
+  c2dSize best = PREP_TAUTOLOGY;
+  c2dSize hits, flips;
+  LitCode code = 0, flip = 0;
+  LitCode* codes = prep->store.codes+prep->store.starts[id];
+  LitCode* other;
+  c2dSize size = prep->sizes[id];
+
+  for (i=0; i<size; i++)
+    if (prep->counts[codes[i]]+prep->counts[codes[i]^1]<best) {
+      best = prep->counts[codes[i]]+prep->counts[codes[i]^1];
+      code = codes[i];
+    }
+  if (size==0 || best>PREP_SUBSUME_LIMIT)
+    return;
+  count = prepOccurs(prep, code)+prepOccurs(prep, code^1);
+  prepGather(prep, code);
+
+  for (i=0; i<size; i++)
+    prep->marks[codes[i]] = 1;
+  for (i=0; i<count && !prep->unsat; i++) {
+    d = prep->ids[i];
+    if (d==id || prep->removed[d] || prep->sizes[d]<size || (prep->signs[id] & ~prep->signs[d]))
+      continue;
+    other = prep->store.codes+prep->store.starts[d];
+    hits = flips = 0;
+    for (j=0; j<prep->sizes[d]; j++) {
+      if (prep->marks[other[j]])
+        hits++;
+      else if (prep->marks[other[j]^1]) {
+        flips++;
+        flip = other[j];
+      }
+    }
+    prep->steps += prep->sizes[d];
+    if (hits+flips<size || flips>1)
+      continue;
+    if (flips==0) {
+      prepRemove(prep, d);
+      sat_state->prepStats.subsumed++;
+    }
+    else {
+      prepStrengthen(prep, d, flip);
+      sat_state->prepStats.strengthened++;
+    }
+  }
+  for (i=0; i<size; i++)
+    prep->marks[codes[i]] = 0;
+}
+/******************************************************************************
+* backward subsumption of the queued clauses, with the unit clauses found
+* on the way, until the queue is empty or the work bound is reached
+*******************************************************************************/
+void prepSubsume(Prep* prep, SatState* sat_state) {
+  c2dSize id;
+  clock_t start = clock();
+
+  while (1) {
+    prepPropagate(prep, sat_state);
+    if (prep->unsat || prep->queueSize==0 || prep->steps>PREP_STEPS)
+      break;
+    id = prep->queue[--prep->queueSize];
+    prep->queued[id] = 0;
+    if (!prep->removed[id])
+      prepBackward(prep, id, sat_state);
+  }
+  sat_state->prepStats.subsumeTime += ((double)(clock()-start))/CLOCKS_PER_SEC;
+}
+/******************************************************************************
+* prepComponents :
+* Tarjan's strongly connected components of the binary implication graph, a
+* literal implying the other literal of each binary clause with its opposite
+* (binaries of the sat state, so learned ones too), without recursion
+* each literal gets the least code of its component as representative: the
+* component of the opposite literals has the opposite codes, so the
+* representative of the opposite of a literal is the opposite of its own,
+* unless the literal and its opposite are in the same component
+*******************************************************************************/
+void prepComponents(Prep* prep, SatState* sat_state) {
+  c2dSize root, i, k, top = 0, depth = 0, order = 0;
+  c2dSize n2 = 2*sat_state->n;
+  c2dSize* index = (c2dSize*)calloc(n2, sizeof(c2dSize)); // 0 until visited
+  c2dSize* low = (c2dSize*)malloc(sizeof(c2dSize)*(n2+1));
+  c2dSize* next = (c2dSize*)malloc(sizeof(c2dSize)*(n2+1)); // next edge to follow
+  LitCode* stack = (LitCode*)malloc(sizeof(LitCode)*(n2+1)); // visited, component not found yet
+  LitCode* path = (LitCode*)malloc(sizeof(LitCode)*(n2+1)); // the depth first search
+  BOOLEAN* onStack = (BOOLEAN*)calloc(n2+1, sizeof(BOOLEAN));
+  LitCode code, other, least;
+  BinaryList* list;
+
+  for (root=0; root<n2; root++) {
+    if (index[root])
+      continue;
+    index[root] = low[root] = ++order;
+    next[root] = 0;
+    stack[top++] = root;
+    onStack[root] = 1;
+    path[depth++] = root;
+    while (depth>0) {
+      code = path[depth-1];
+      list = &sat_state->binaries[code^1]; // the clauses that become unit when code is set
+      if (next[code]<list->size) {
+        other = list->others[next[code]++];
+        prep->steps++;
+        if (!index[other]) {
+          index[other] = low[other] = ++order;
+          next[other] = 0;
+          stack[top++] = other;
+          onStack[other] = 1;
+          path[depth++] = other;
+        }
+        else if (onStack[other] && index[other]<low[code])
+          low[code] = index[other];
+        continue;
+      }
+      depth--;
+      if (depth>0 && low[code]<low[path[depth-1]])
+        low[path[depth-1]] = low[code];
+      if (low[code]!=index[code])
+        continue;
+      for (k=top-1; stack[k]!=code; k--)
+        ;
+      least = code;
+      for (i=k; i<top; i++)
+        if (stack[i]<least)
+          least = stack[i];
+      for (i=k; i<top; i++) {
+        prep->repr[stack[i]] = least;
+        onStack[stack[i]] = 0;
+      }
+      top = k;
+    }
+  }
+  free(index);
+  free(low);
+  free(next);
+  free(stack);
+  free(path);
+  free(onStack);
+}
+/******************************************************************************
+* prepEquivalences :
+* each variable whose literals have another representative is substituted:
+* its clauses are replaced by their rewriting with the representatives,
+* without the ones this turns into tautologies (the binary clauses of the
+* equivalence among them), and the two clauses of the equivalence go on the
+* elimination stack, to set it like its representative
+* a literal equivalent to its opposite makes the cnf unsatisfiable
+*******************************************************************************/
+void prepEquivalences(Prep* prep, SatState* sat_state) {
+  c2dSize i, j, id, size;
+  c2dSize count = prep->store.count;
+  c2dSize substituted = 0;
+  LitCode code;
+  LitCode* codes;
+  BOOLEAN tautology;
+  clock_t start = clock();
+
+  prepComponents(prep, sat_state);
+  for (i=0; i<sat_state->n && !prep->unsat; i++) {
+    code = prep->repr[2*i];
+    if (code==prep->repr[2*i+1])
+      prep->unsat = 1;
+    else if (code!=2*i) {
+      prep->gone[i] = 1;
+      substituted++;
+      elimPush(2*i, sat_state);
+      elimPush(code^1, sat_state);
+      elimPush(2, sat_state);
+      elimPush(2*i+1, sat_state);
+      elimPush(code, sat_state);
+      elimPush(2, sat_state);
+    }
+  }
+  for (id=0; id<count && substituted>0 && !prep->unsat; id++) {
+    if (prep->removed[id])
+      continue;
+    codes = prep->store.codes+prep->store.starts[id];
+    for (j=0; j<prep->sizes[id] && prep->repr[codes[j]]==codes[j]; j++)
+      ;
+    if (j==prep->sizes[id])
+      continue;
+    size = 0;
+    tautology = 0;
+    for (j=0; j<prep->sizes[id] && !tautology; j++) {
+      code = prep->repr[codes[j]];
+      if (prep->marks[code^1])
+        tautology = 1;
+      else if (!prep->marks[code]) {
+        prep->marks[code] = 1;
+        prep->buffer[size++] = code;
+      }
+    }
+    for (j=0; j<size; j++)
+      prep->marks[prep->buffer[j]] = 0;
+    prep->steps += prep->sizes[id];
+    prepRemove(prep, id);
+    if (tautology)
+      continue;
+    for (j=0; j<size; j++)
+      storeAdd(&prep->store, prep->buffer[j], sat_state);
+    prepAdd(prep, sat_state);
+  }
+  sat_state->prepStats.substituted += substituted;
+  sat_state->determined += prep->count*substituted;
+  sat_state->prepStats.substituteTime += ((double)(clock()-start))/CLOCKS_PER_SEC;
+}
+/******************************************************************************
+* prepLearned :
+* the learned clauses, taken out of the sat state before prepFinish(), are
+* rewritten with the representatives and the literals set, then attached
+* again after the cnf clauses (they are implied by the cnf left, since it
+* is the cnf they were learned from but for the variables it took out)
+* those satisfied, or left empty, are freed
+*******************************************************************************/
+void prepLearned(Prep* prep, Clause** learned, c2dSize count, SatState* sat_state) {
+  c2dSize i, j, size;
+  LitCode code;
+  Clause* clause;
+  BOOLEAN satisfied;
+
+  deltaFit(sat_state->m+count, sat_state);
+  for (i=0; i<count; i++) {
+    clause = learned[i];
+    size = 0;
+    satisfied = 0;
+    for (j=0; j<clause->size && !satisfied; j++) {
+      code = prep->repr[clause->codes[j]];
+      if (prep->value[code] || prep->marks[code^1])
+        satisfied = 1;
+      else if (!prep->value[code^1] && !prep->marks[code]) {
+        prep->marks[code] = 1;
+        clause->codes[size++] = code;
+      }
+    }
+    for (j=0; j<size; j++)
+      prep->marks[clause->codes[j]] = 0;
+    free(clause->lits);
+    clause->lits = NULL;
+    if (satisfied || size==0) {
+      free(clause);
+      continue;
+    }
+    clause->size = size;
+    sat_state->delta[sat_state->m+sat_state->l++] = clause;
+    clause->index = sat_state->m+sat_state->l;
+    clauseAttach(clause, sat_state);
+  }
+}
+/******************************************************************************
+* the resolvent of clause a, that has the literal pivot, and clause b, that
+* has its opposite, is left in buffer
+* returns its size, or PREP_TAUTOLOGY
+*******************************************************************************/
+c2dSize prepResolve(Prep* prep, c2dSize a, c2dSize b, LitCode pivot) {
+  c2dSize i;
+  c2dSize size = 0;
+  BOOLEAN tautology = 0;
+  LitCode* codes = prep->store.codes+prep->store.starts[a];
+  LitCode* other = prep->store.codes+prep->store.starts[b];
+
+  for (i=0; i<prep->sizes[a]; i++)
+    if (codes[i]!=pivot) {
+      prep->marks[codes[i]] = 1;
+      prep->buffer[size++] = codes[i];
+    }
+  for (i=0; i<prep->sizes[b] && !tautology; i++) {
+    if (other[i]==(pivot^1))
+      continue;
+    if (prep->marks[other[i]^1])
+      tautology = 1;
+    else if (!prep->marks[other[i]])
+      prep->buffer[size++] = other[i];
+  }
+  for (i=0; i<prep->sizes[a]; i++)
+    prep->marks[codes[i]] = 0;
+  prep->steps += prep->sizes[a]+prep->sizes[b];
+  return tautology ? PREP_TAUTOLOGY : size;
+}
+/******************************************************************************
+* prepGate :
+* look among the clauses of a variable, in ids as prepGather() left them
+* (p with its positive literal then q with its negative one), for a gate
+* that defines it: a literal l of the variable and a clause (l,-a1,..,-ak)
+* with each binary clause (-l,ai), so that l is the and of a1..ak
+* (k==1 for an equivalence), flagged in gate
+* returns 1 if there is one
+*******************************************************************************/
+BOOLEAN prepGate(Prep* prep, LitCode pos, c2dSize p, c2dSize q) {
+  c2dSize side, i, j, k, from, size;
+  c2dSize count[2] = { p, q };
+  c2dSize start[2] = { 0, p };
+  LitCode lit;
+  LitCode* codes;
+  BOOLEAN found = 0;
+
+  memset(prep->gate, 0, sizeof(BOOLEAN)*(p+q));
+  for (side=0; side<2 && !found; side++) {
+    lit = pos+side; // the output of the gate, its clauses with -lit are the binary ones
+    from = start[1-side];
+    for (j=from; j<from+count[1-side]; j++)
+      if (prep->sizes[prep->ids[j]]==2) {
+        codes = prep->store.codes+prep->store.starts[prep->ids[j]];
+        prep->marks[codes[0]==(lit^1) ? codes[1] : codes[0]] = 1;
+      }
+    for (i=start[side]; i<start[side]+count[side] && !found; i++) {
+      codes = prep->store.codes+prep->store.starts[prep->ids[i]];
+      size = prep->sizes[prep->ids[i]];
+      found = size>=2;
+      for (k=0; k<size && found; k++)
+        found = codes[k]==lit || prep->marks[codes[k]^1];
+    }
+    for (j=from; j<from+count[1-side]; j++)
+      if (prep->sizes[prep->ids[j]]==2) {
+        codes = prep->store.codes+prep->store.starts[prep->ids[j]];
+        prep->marks[codes[0]==(lit^1) ? codes[1] : codes[0]] = 0;
+      }
+    if (!found)
+      continue;
+
+    // the gate: the clause found and one binary clause for each of its other literals
+    prep->gate[--i] = 1;
+    codes = prep->store.codes+prep->store.starts[prep->ids[i]];
+    for (k=0; k<size; k++)
+      prep->marks[codes[k]] = 1;
+    for (j=from; j<from+count[1-side]; j++)
+      if (prep->sizes[prep->ids[j]]==2) {
+        codes = prep->store.codes+prep->store.starts[prep->ids[j]];
+        k = codes[0]==(lit^1) ? codes[1] : codes[0];
+        if (prep->marks[k^1]) {
+          prep->gate[j] = 1;
+          prep->marks[k^1] = 0; // one clause for each
+        }
+      }
+    codes = prep->store.codes+prep->store.starts[prep->ids[i]];
+    for (k=0; k<size; k++)
+      prep->marks[codes[k]] = 0;
+  }
+  return found;
+}
+/******************************************************************************
+* prepEliminate :
+* replace the clauses of a variable by their resolvents on it, unless these
+* are more than the clauses or one of them is longer than PREP_RESOLVENT_LIMIT
+* with a gate, two gate clauses resolve to a tautology and two other clauses
+* to a clause the others imply, so neither pair is resolved
+* the clauses of the literal with fewer of them go on the elimination stack,
+* after a unit clause for the other literal, which the variable gets unless
+* one of them needs the literal
+* returns 1 if the variable is eliminated
+*******************************************************************************/
+BOOLEAN prepEliminate(Prep* prep, c2dSize var, SatState* sat_state) {
+  c2dSize i, j, k, size, from, to;
+  c2dSize count = 0;
+  LitCode pos = 2*var;
+  LitCode pivot;
+  LitCode* codes;
+  BOOLEAN gate;
+  c2dSize p = prepOccurs(prep, pos);
+  c2dSize q = prepOccurs(prep, pos+1);
+
+  if (p+q==0)
+    return 0;
+  prepGather(prep, pos);
+  gate = prepGate(prep, pos, p, q);
+  if (!gate && (prep->count || (p>PREP_OCCUR_LIMIT && q>PREP_OCCUR_LIMIT)))
+    return 0;
+  prep->steps += p*q;
+  for (i=0; i<p; i++)
+    for (j=0; j<q; j++) {
+      if (gate && prep->gate[i]==prep->gate[p+j])
+        continue;
+      size = prepResolve(prep, prep->ids[i], prep->ids[p+j], pos);
+      if (size==PREP_TAUTOLOGY)
+        continue;
+      if (size>PREP_RESOLVENT_LIMIT || ++count>p+q)
+        return 0;
+    }
+
+  prep->gone[var] = 1;
+  for (i=0; i<p; i++)
+    for (j=0; j<q; j++) {
+      if (gate && prep->gate[i]==prep->gate[p+j])
+        continue;
+      size = prepResolve(prep, prep->ids[i], prep->ids[p+j], pos);
+      if (size==PREP_TAUTOLOGY)
+        continue;
+      for (k=0; k<size; k++)
+        storeAdd(&prep->store, prep->buffer[k], sat_state);
+      prepAdd(prep, sat_state);
+    }
+  pivot = p<=q ? pos : pos+1;
+  from = p<=q ? 0 : p;
+  to = p<=q ? p : p+q;
+  for (i=from; i<to; i++) {
+    codes = prep->store.codes+prep->store.starts[prep->ids[i]];
+    elimPush(pivot, sat_state);
+    for (k=0; k<prep->sizes[prep->ids[i]]; k++)
+      if (codes[k]!=pivot)
+        elimPush(codes[k], sat_state);
+    elimPush(prep->sizes[prep->ids[i]], sat_state);
+  }
+  elimPush(pivot^1, sat_state);
+  elimPush(1, sat_state);
+  for (i=0; i<p+q; i++)
+    prepRemove(prep, prep->ids[i]);
+  prep->occurs[pos].size = 0;
+  prep->occurs[pos+1].size = 0;
+  sat_state->prepStats.eliminated++;
+  sat_state->prepStats.gates += gate;
+  sat_state->prepStats.resolvents += count;
+  sat_state->determined += prep->count;
+  return 1;
+}
+/******************************************************************************
+* the touched variables are tried for elimination, those with fewer clauses
+* first, then the variables touched by the eliminations, and so on
+*******************************************************************************/
+void prepElimination(Prep* prep, SatState* sat_state) {
+  c2dSize i, var, count;
+  uint64_t* keys;
+  double subsumeTime;
+  clock_t start;
+
+  while (!prep->unsat && prep->touchCount>0 && prep->steps<=PREP_STEPS) {
+    start = clock();
+    subsumeTime = sat_state->prepStats.subsumeTime;
+    count = prep->touchCount;
+    keys = (uint64_t*)malloc(sizeof(uint64_t)*count);
+    for (i=0; i<count; i++) {
+      var = prep->touchList[i];
+      prep->touched[var] = 0;
+      keys[i] = ((uint64_t)(prep->counts[2*var]+prep->counts[2*var+1])<<32) | var;
+    }
+    prep->touchCount = 0;
+    qsort(keys, count, sizeof(uint64_t), prepCompare);
+    for (i=0; i<count && !prep->unsat && prep->steps<=PREP_STEPS; i++) {
+      var = keys[i] & 0xffffffff;
+      if (!prep->gone[var] && prepEliminate(prep, var, sat_state))
+        prepSubsume(prep, sat_state); // the resolvents, and the units among them
+    }
+    free(keys);
+    sat_state->prepStats.eliminateTime += ((double)(clock()-start))/CLOCKS_PER_SEC
+                                          -(sat_state->prepStats.subsumeTime-subsumeTime);
+  }
+}
+int prepCompare(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*)a;
+  uint64_t y = *(const uint64_t*)b;
+
+  return x<y ? -1 : x>y;
+}
+/******************************************************************************
+* occurAdd, occurDelete : the occurrence lists of prep
+*******************************************************************************/
+void occurAdd(OccurList* list, c2dSize id) {
+  if (list->size==list->cap) {
+    list->cap = list->cap ? 2*list->cap : 4;
+    list->ids = realloc(list->ids, sizeof(c2dSize)*list->cap);
+  }
+  list->ids[list->size++] = id;
+}
+void occurDelete(OccurList* list, c2dSize id) {
+  c2dSize i;
+
+  for (i=list->size; i>0; i--)
+    if (list->ids[i-1]==id) {
+      list->ids[i-1] = list->ids[--list->size];
+      return;
+    }
+}
+/******************************************************************************
+* one code on the elimination stack of the sat state
+*******************************************************************************/
+void elimPush(LitCode code, SatState* sat_state) {
+  if (sat_state->elimSize==sat_state->elimCap) {
+    sat_state->elimCap = sat_state->elimCap ? 2*sat_state->elimCap : 64;
+    sat_state->elimStack = realloc(sat_state->elimStack, sizeof(LitCode)*sat_state->elimCap);
+  }
+  sat_state->elimStack[sat_state->elimSize++] = code;
+}
+/******************************************************************************
+ * end
+ ******************************************************************************/
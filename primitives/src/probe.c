@@ -0,0 +1,186 @@
+#include <time.h>
+
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* failed literal probing
+*
+* sat_probe() decides the literals of each candidate variable in turn, at
+* level 2 over the level 1 of sat_unit_resolution():
+* --a probe that fails learns a clause that asserts at level 1, and it is
+*   asserted there, setting the opposite of the probe (or of a literal the
+*   probe implies)
+* --the literals implied by both probes of a variable are implied by the cnf,
+*   each is learned as a unit clause and set at level 1
+* --a literal implied through a longer clause gets a binary clause with the
+*   literal of the probe it follows from (the one false literal of that
+*   clause set at level 2, else the opposite of the probe): a hyper-binary
+*   resolvent, so later probes and the search get it through the binaries
+* the learned clauses are implied by the cnf, so the model count is kept
+* the candidates follow PROBE_ORDER, the pass stops once the probes have set
+* PROBE_STEPS literals (a bound on the work that does not depend on the time,
+* so the pass probes the same literals from one run to the next)
+*******************************************************************************/
+/******************************************************************************
+* the whole pass, at level 1 once sat_unit_resolution() succeeded
+* returns 0 if the cnf is found unsatisfiable
+*******************************************************************************/
+BOOLEAN probe(SatState* sat_state) {
+  c2dSize i, j, var, count;
+  uint64_t* keys;
+  Probe pr;
+  Var* v;
+  Clause* learned;
+  BOOLEAN sat = 1;
+  ProbeStats* stats = &sat_state->probeStats;
+  clock_t start = clock();
+
+  pr.stamps = (c2dSize*)calloc(2*sat_state->n+1, sizeof(c2dSize));
+  pr.stamp = 0;
+  pr.lifted = (LitCode*)malloc(sizeof(LitCode)*(sat_state->n+1));
+  pr.liftedCount = 0;
+  pr.hyperCap = 64;
+  pr.hyper = (LitCode*)malloc(sizeof(LitCode)*pr.hyperCap);
+  pr.hyperCount = 0;
+  pr.steps = 0;
+
+  keys = (uint64_t*)malloc(sizeof(uint64_t)*(sat_state->n+1));
+  count = probeOrder(keys, sat_state);
+  for (i=0; i<count && sat; i++) {
+    if (pr.steps>PROBE_STEPS)
+      break;
+    var = keys[i] & 0xffffffff;
+    v = sat_state->variables[var];
+    if (sat_instantiated_var(v))
+      continue;
+    pr.stamp++;
+    pr.liftedCount = 0;
+    learned = probeLiteral(v->pos, 0, &pr, sat_state);
+    if (learned==NULL && !sat_instantiated_var(v))
+      learned = probeLiteral(v->neg, 1, &pr, sat_state);
+    if (learned!=NULL) {
+      stats->failed++;
+      sat = sat_assert_clause(learned, sat_state)==NULL; // a conflict at level 1 has no decision to undo
+      continue;
+    }
+    for (j=0; j<pr.liftedCount && sat; j++)
+      if (!sat_implied_literal(&sat_state->literals[pr.lifted[j]])) {
+        stats->lifted++;
+        sat = probeUnit(&sat_state->literals[pr.lifted[j]], sat_state)==NULL;
+      }
+  }
+  free(keys);
+  free(pr.stamps);
+  free(pr.lifted);
+  free(pr.hyper);
+  stats->time += ((double)(clock()-start))/CLOCKS_PER_SEC;
+  return sat;
+}
+/******************************************************************************
+* the candidate variables (index-1) in the order they are probed, in the low
+* bits of keys, those mentioned by no clause left out
+* returns their number
+*******************************************************************************/
+c2dSize probeOrder(uint64_t* keys, SatState* sat_state) {
+  c2dSize i, binaries;
+  c2dSize count = 0;
+
+  for (i=0; i<sat_state->n; i++) {
+    if (sat_state->varUnsubsumed[i]==0)
+      continue;
+    binaries = sat_state->binaries[2*i].size+sat_state->binaries[2*i+1].size;
+    if (PROBE_ORDER==0)
+      keys[count++] = i;
+    else if (PROBE_ORDER==1)
+      keys[count++] = ((uint64_t)(0xffffffff-(binaries<0xffffffff ? binaries : 0xffffffff))<<32) | i;
+    else if ((sat_state->binaries[2*i].size==0)!=(sat_state->binaries[2*i+1].size==0)) // one literal is a root
+      keys[count++] = i;
+  }
+  qsort(keys, count, sizeof(uint64_t), prepCompare);
+  return count;
+}
+/******************************************************************************
+* probeLiteral :
+* decide a literal at level 2 and undo it, keeping what it implies:
+* the first probe of a variable stamps its literals, the second one (last)
+* lifts those the first one stamped, both record their hyper-binary
+* resolvents, which are learned once back at level 1
+* returns the learned clause if the probe fails
+*******************************************************************************/
+Clause* probeLiteral(Lit* lit, BOOLEAN last, Probe* pr, SatState* sat_state) {
+  c2dSize i, j, k, level2;
+  c2dSize start = sat_state->setCount;
+  Lit* implied;
+  Lit* lits[2];
+  Reason reason;
+  Clause* clause;
+  Clause* learned;
+  LitCode other = 0;
+
+  sat_state->probeStats.probed++;
+  pr->hyperCount = 0;
+  learned = sat_decide_literal(lit, sat_state);
+  for (i=start+1; i<sat_state->setCount && learned==NULL; i++) {
+    implied = sat_state->set[i];
+    if (!last)
+      pr->stamps[implied->code] = pr->stamp;
+    else if (pr->stamps[implied->code]==pr->stamp)
+      pr->lifted[pr->liftedCount++] = implied->code;
+    reason = REASON(implied, sat_state);
+    if (reason==0 || REASON_IS_BINARY(reason))
+      continue;
+    clause = (Clause*)reason;
+    level2 = 0;
+    for (j=0; j<clause->size; j++)
+      if (clause->codes[j]!=implied->code && sat_state->litLevel[clause->codes[j]^1]>1) {
+        level2++;
+        other = clause->codes[j];
+      }
+    if (pr->hyperCount+2>pr->hyperCap) {
+      pr->hyperCap *= 2;
+      pr->hyper = realloc(pr->hyper, sizeof(LitCode)*pr->hyperCap);
+    }
+    pr->hyper[pr->hyperCount++] = level2==1 ? other : lit->code^1;
+    pr->hyper[pr->hyperCount++] = implied->code;
+  }
+  pr->steps += sat_state->setCount-start;
+  sat_undo_decide_literal(sat_state);
+  if (learned!=NULL)
+    return learned;
+
+  for (k=0; k<pr->hyperCount; k+=2) {
+    lits[0] = &sat_state->literals[pr->hyper[k]];
+    lits[1] = &sat_state->literals[pr->hyper[k+1]];
+    if (sat_state->litLevel[lits[0]->code]>0 || sat_state->litLevel[lits[1]->code]>0)
+      continue; // satisfied at level 1
+    probeLearn(2, lits, sat_state);
+    sat_state->probeStats.hyper++;
+  }
+  return NULL;
+}
+/******************************************************************************
+* probeLearn, probeUnit :
+* a clause implied by the cnf is added to the learned clauses, at level 1
+* where none of its literals is set; a unit clause then has its literal set,
+* like sat_assert_clause() sets the literal of a learned clause
+* probeUnit() returns a learned clause if this leads to a contradiction
+*******************************************************************************/
+Clause* probeLearn(c2dSize size, Lit** lits, SatState* sat_state) {
+  Clause* clause = learnedAdd(size, lits, sat_state);
+
+  clause->setLevel = 1;
+  clauseAttach(clause, sat_state);
+  return clause;
+}
+Clause* probeUnit(Lit* lit, SatState* sat_state) {
+  Clause* clause = probeLearn(1, &lit, sat_state);
+
+  sat_state->learned = lit;
+  sat_state->assertionLevel = 1;
+  REASON(lit, sat_state) = (Reason)clause;
+  return sat_assert_clause(clause, sat_state);
+}
+/******************************************************************************
+ * end
+ ******************************************************************************/
@@ -35,17 +35,7 @@ BOOLEAN sat_instantiated_var(const Var* var) {
 }
 //returns 1 if all the clauses mentioning the variable are subsumed, 0 otherwise
 BOOLEAN sat_irrelevant_var(const Var* var) {
-  c2dSize i;
-  Clause* clause;
-
-  for (i=0; i<sat_var_occurences(var); i++) {
-    clause = sat_clause_of_var(i, var);
-    if (sat_subsumed_clause(clause))
-      continue;
-    else
-      return 0;
-  }
-  return 1;
+  return var->unsubsumed[var->index-1]==0;
 }
 //returns the number of variables in the cnf of sat state
 c2dSize sat_var_count(const SatState* sat_state) {
@@ -94,7 +84,7 @@ Lit* sat_neg_literal(const Var* var) {
 //returns 1 if the literal is implied, 0 otherwise
 //a literal is implied by deciding its variable, or by inference using unit resolution
 BOOLEAN sat_implied_literal(const Lit* lit) {
-  return lit->setLevel > 0;
+  return lit->level[lit->code] > 0;
 }
 //sets the literal to true, and then runs unit resolution
 //returns a learned clause if unit resolution detected a contradiction, NULL otherwise
@@ -106,6 +96,8 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
   ASSERT_TEST(!sat_implied_literal(lit)); // this literal should not be set 
   ASSERT_TEST(!sat_implied_literal(lit->opp)); // opposite literal should not be set (conflict testing in a different way)
   
+  if (sat_state->phase==2 && sat_state->setCount>sat_state->targetSize)
+    phaseTarget(sat_state); // the trail is the largest one without conflict so far
   sat_state->currentLevel++;
   
   // free(sat_state->queue);
@@ -114,7 +106,7 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
   sat_state->queueSize = 1;
   sat_state->queue[0] = lit;
 
-  lit->inQueue = 1; // mark the lit as in the toSet list
+  QUEUED(lit, sat_state) = 1; // mark the lit as in the toSet list
   if (sat_unit_resolution(sat_state))
     return NULL;
   else
@@ -130,6 +122,57 @@ void sat_undo_decide_literal(SatState* sat_state) {
   ASSERT_TEST(sat_state->currentLevel>=1)
   return;
 }
+//undoes the decisions above level in one pass, restoring the clauses each literal subsumed at its level
+void sat_backtrack(c2dSize level, SatState* sat_state) {
+  Lit* lit;
+
+  ASSERT_TEST(level>=1 && level<=sat_state->currentLevel);
+  while (sat_state->setCount>0) {
+    lit = sat_state->set[sat_state->setCount-1];
+    if (LEVEL(lit, sat_state)<=level)
+      break;
+    sat_state->currentLevel = LEVEL(lit, sat_state); // the level literalUnset() restores
+    literalUnset(lit, sat_state);
+    sat_state->setCount--;
+  }
+  sat_state->currentLevel = level;
+  sat_state->setHead = sat_state->setCount;
+  sat_state->xorHead = sat_state->setCount;
+  if (sat_state->setCount<sat_state->targetSame)
+    sat_state->targetSame = sat_state->setCount;
+}
+//returns the literal of the free variable with the highest activity, see order.c
+Lit* sat_next_decision(SatState* sat_state) {
+  Var* var = orderNext(sat_state);
+
+  return var==NULL ? NULL : sat_phase_literal(var, sat_state);
+}
+//returns the literal of a variable that the phase of sat state prefers
+Lit* sat_phase_literal(const Var* var, const SatState* sat_state) {
+  BOOLEAN value;
+
+  switch (sat_state->phase) {
+    case 0:
+      value = 1;
+      break;
+    case 1:
+      value = sat_state->varPhase[var->index-1];
+      break;
+    default:
+      value = sat_state->varTarget[var->index-1];
+  }
+  return value ? var->pos : var->neg;
+}
+//sets the phase of sat state, 0 (positive), 1 (saved) or 2 (target)
+void sat_set_phase(BOOLEAN phase, SatState* sat_state) {
+  ASSERT_TEST(phase<=2);
+  sat_state->phase = phase;
+}
+//gives the variables random activities from seed, see order.c
+void sat_seed_order(c2dSize seed, SatState* sat_state) {
+  ASSERT_TEST(sat_state->currentLevel==1);
+  orderSeed(seed, sat_state);
+}
 /******************************************************************************
  * Clauses 
  ******************************************************************************/
@@ -144,7 +187,12 @@ c2dSize sat_clause_index(const Clause* clause) {
 }
 //returns the literals of a clause
 Lit** sat_clause_literals(const Clause* clause) {
-  return clause->lits;
+  return clause_view((Clause*)clause);
+}
+//returns the index of the literal at position i of a clause
+c2dLiteral sat_clause_literal_index(c2dSize i, const Clause* clause) {
+  ASSERT_TEST(i<clause->size);
+  return clause->table[clause->codes[i]].index;
 }
 //returns the number of literals in a clause
 c2dSize sat_clause_size(const Clause* clause) {
@@ -162,6 +210,15 @@ c2dSize sat_clause_count(const SatState* sat_state) {
 c2dSize sat_learned_clause_count(const SatState* sat_state) {
   return sat_state->l;
 }
+//adds a clause to the cnf of a sat state between calls of sat_solve(), see solve.c
+BOOLEAN sat_add_clause(const c2dLiteral* literals, c2dSize size, SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending==NULL && sat_state->currentLevel==1 && sat_state->setCount==0);
+  return clauseAdd(literals, size, sat_state);
+}
+//returns the lbd of a learned clause
+c2dSize sat_clause_lbd(const Clause* clause) {
+  return clause->lbd;
+}
 //adds clause to the set of learned clauses, and runs unit resolution
 //returns a learned clause if unit resolution finds a contradiction, NULL otherwise
 //
@@ -190,17 +247,10 @@ Clause* sat_assert_clause(Clause* clause, SatState* sat_state) {
  * You should also write a function that frees the memory allocated by a
  * SatState (sat_state_free)
  ******************************************************************************/
-//constructs a SatState from an input cnf file
+//constructs a SatState from an input cnf file (dimacs, or a snapshot written by sat_state_save())
 SatState* sat_state_new(const char* file_name) {
-  SatState* sat_state = (SatState*)malloc(sizeof(SatState));
-
-  sat_state->l = 0;
-  sat_state->currentLevel = 1;
-  sat_state->assertionLevel = 0;
-  sat_state->learned = NULL;
-  sat_state->setCount = 0;
-  sat_state->queueSize = 0;
-  sat_state->conflict = 0; 
+  SatState* sat_state = stateNew();
+
   /***************************************************************
   struct clause**     delta; //database, clauses for this cnf
   c2dSize             clauseCap;
@@ -210,15 +260,10 @@ SatState* sat_state_new(const char* file_name) {
   struct literal**    set;  //currently implied
   struct literal**    queue; // resolution queue 
   *****************************************************************/
-  FILE *fin;
-  fin = fopen(file_name, "rb");
-  if (fin == NULL) {
-    fprintf(stderr, "ERROR! Could not open file: %s\n", file_name);
+  if (!loadFile(file_name, sat_state)) {
+    free(sat_state);
     return NULL;
   }
-  char* inputStream = readFile(fin);
-  parseFile(inputStream, sat_state);
-  free(inputStream);
 
   if (PRINT) {
     c2dSize i = 0, j=0;
@@ -240,25 +285,219 @@ SatState* sat_state_new(const char* file_name) {
   return sat_state;
 }
 
+//constructs a SatState over n variables from m clauses in memory, clause i has sizes[i] literals
+//and the literals of the clauses follow one another in literals (i or -i for variable i)
+SatState* sat_state_from_clauses(c2dSize n, c2dSize m, const c2dSize* sizes, const c2dLiteral* literals) {
+  c2dSize i;
+  c2dSize total = 0;
+  SatState* sat_state = sat_state_builder(n);
+
+  for (i=0; i<m; i++)
+    total += sizes[i];
+  storeReserve(sat_state->pending, m, total);
+  for (i=0; i<m; i++) {
+    if (!sat_state_add_clause(literals, sizes[i], sat_state)) {
+      sat_state_free(sat_state);
+      return NULL;
+    }
+    literals += sizes[i];
+  }
+  sat_state_build(sat_state);
+  return sat_state;
+}
+
+//starts a SatState over n variables, its clauses are given by sat_state_add_clause()
+//the clauses are kept as codes until sat_state_build() places them like the file loader does
+SatState* sat_state_builder(c2dSize n) {
+  SatState* sat_state = stateNew();
+
+  sat_state->n = n;
+  sat_state->m = 0;
+  stateAlloc(sat_state);
+  sat_state->pending = (ClauseStore*)malloc(sizeof(ClauseStore));
+  storeInit(sat_state->pending);
+  return sat_state;
+}
+
+//adds a clause to a SatState that is being built
+BOOLEAN sat_state_add_clause(const c2dLiteral* literals, c2dSize size, SatState* sat_state) {
+  c2dSize i;
+
+  ASSERT_TEST(sat_state->pending!=NULL);
+  for (i=0; i<size; i++) {
+    if (literals[i]==0 || literals[i]>(c2dLiteral)sat_state->n || -literals[i]>(c2dLiteral)sat_state->n) {
+      storeDrop(sat_state->pending, sat_state);
+      return 0;
+    }
+    storeAdd(sat_state->pending, LITERAL_CODE(literals[i]), sat_state);
+  }
+  storeClose(sat_state->pending, sat_state);
+  return 1;
+}
+
+//ends the building of a SatState
+void sat_state_build(SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending!=NULL);
+  sat_state->m = sat_state->pending->count;
+  storeBuild(sat_state->pending, sat_state);
+  xorDetect(sat_state);
+  storeFree(sat_state->pending);
+  free(sat_state->pending);
+  sat_state->pending = NULL;
+}
+
+//writes the cnf of sat state as a binary snapshot, that sat_state_new() loads
+//without parsing (learned clauses are not written)
+//a sat state given clauses by sat_add_clause() is not written, they are not in its cnf
+BOOLEAN sat_state_save(const SatState* sat_state, const char* file_name) {
+  BOOLEAN done;
+  FILE* fout;
+
+  if (sat_state->solveStats.added>0)
+    return 0;
+  fout = fopen(file_name, "wb");
+  if (fout == NULL) {
+    fprintf(stderr, "ERROR! Could not open file: %s\n", file_name);
+    return 0;
+  }
+  done = snapshotSave(sat_state, fout);
+  if (fclose(fout)!=0)
+    done = 0;
+  return done;
+}
+
+//simplifies the cnf of a sat state, before unit resolution is run on it
+//see preprocess.c
+//a sat state with learned clauses, or given clauses by sat_add_clause(), is refused (2, not 0 for
+//an unsatisfiable cnf): only the cnf clauses are simplified, and the others would be dropped when
+//the cnf is placed again
+BOOLEAN sat_preprocess(SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending==NULL && sat_state->setCount==0);
+  if (sat_state->l>0 || sat_state->solveStats.added>0)
+    return 2;
+  return preprocess(sat_state, 0);
+}
+
+//simplifies the cnf of a sat state keeping its model count, for the knowledge compiler
+BOOLEAN sat_preprocess_count(SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending==NULL && sat_state->setCount==0);
+  if (sat_state->l>0 || sat_state->solveStats.added>0)
+    return 2;
+  return preprocess(sat_state, 1);
+}
+
+//replaces equivalent literals by one of their class, in the cnf and learned clauses
+BOOLEAN sat_substitute_equivalences(SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending==NULL && sat_state->setCount==0);
+  return substitute(sat_state);
+}
+
+//at-most-one constraints for cliques of binary clauses, see card.c
+c2dSize sat_cardinality(SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending==NULL && sat_state->l==0 && sat_state->setCount==0);
+  return cardDetect(sat_state);
+}
+
+//solves the cnf under assumptions, see solve.c
+BOOLEAN sat_solve(Lit** assumptions, c2dSize count, BOOLEAN* model, Lit** failed, c2dSize* failedCount,
+                  SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending==NULL && sat_state->currentLevel==1 && sat_state->setCount==0);
+  return solve(assumptions, count, model, failed, failedCount, sat_state);
+}
+
+//adds a clause learned by another sat state, see solve.c
+BOOLEAN sat_import_clause(const c2dLiteral* literals, c2dSize size, c2dSize lbd, SatState* sat_state) {
+  ASSERT_TEST(sat_state->pending==NULL && sat_state->currentLevel==1 && sat_state->setHead==sat_state->setCount);
+  return clauseImport(literals, size, lbd, sat_state);
+}
+//the i^th term of the luby sequence, see solve.c
+c2dSize sat_luby(c2dSize i) {
+  ASSERT_TEST(i>=1);
+  return lubyTerm(i);
+}
+
+//failed literal probing, see probe.c
+BOOLEAN sat_probe(SatState* sat_state) {
+  ASSERT_TEST(sat_state->currentLevel==1);
+  return probe(sat_state);
+}
+
+//the literals true in all models of the cnf, see backbone.c
+BOOLEAN sat_backbone(Lit** lits, c2dSize* count, SatState* sat_state) {
+  ASSERT_TEST(sat_state->currentLevel==1);
+  return backbone(lits, count, sat_state);
+}
+
+//returns the number of variables sat_preprocess_count() took out of the cnf
+c2dSize sat_determined_var_count(const SatState* sat_state) {
+  return sat_state->determined;
+}
+
+//extends a model of the preprocessed cnf to the variables set or eliminated by sat_preprocess()
+//the elimination stack is read backwards: a clause none of whose literals is true gets
+//its first literal set
+void sat_extend_model(const SatState* sat_state, BOOLEAN* model) {
+  c2dSize i, j, size;
+  BOOLEAN satisfied;
+  const LitCode* codes;
+
+  for (i=sat_state->elimSize; i>0; i-=size) {
+    size = sat_state->elimStack[--i];
+    codes = sat_state->elimStack+i-size;
+    satisfied = 0;
+    for (j=0; j<size && !satisfied; j++)
+      satisfied = model[codes[j]>>1]==!(codes[j]&1);
+    if (!satisfied)
+      model[codes[0]>>1] = !(codes[0]&1);
+  }
+}
+
 //frees the SatState
 void sat_state_free(SatState* sat_state) {
   c2dSize i;
   
-  for (i=1; i<=sat_var_count(sat_state); i++) {
-    free(sat_pos_literal(sat_index2var(i, sat_state))->occurIn);
-    free(sat_pos_literal(sat_index2var(i, sat_state)));
-    free(sat_neg_literal(sat_index2var(i, sat_state))->occurIn);
-    free(sat_neg_literal(sat_index2var(i, sat_state)));
-    free(sat_index2var(i, sat_state));
+  for (i=0; i<2*sat_var_count(sat_state); i++) {
+    free(sat_state->watches[i].clauses);
+    free(sat_state->binaries[i].others);
+    free(sat_state->ternaries[i].entries);
   }
   for (i=0; i<sat_clause_count(sat_state)+sat_learned_clause_count(sat_state); i++) {
     free(sat_state->delta[i]->lits);
-    free(sat_state->delta[i]);
+    if (i>=sat_clause_count(sat_state)) // cnf clauses are in the arena
+      free(sat_state->delta[i]);
   }
+  arenaFree(sat_state);
+  xorFree(sat_state);
+  cardFree(sat_state);
+  orderFree(sat_state);
   free(sat_state->delta);
   free(sat_state->variables);
+  free(sat_state->varPool);
+  free(sat_state->literals);
+  free(sat_state->litLevel);
+  free(sat_state->litReason);
+  free(sat_state->litSeen);
+  free(sat_state->litQueued);
+  free(sat_state->occurPool);
+  free(sat_state->elimStack);
+  if (sat_state->pending!=NULL) { // never built
+    storeFree(sat_state->pending);
+    free(sat_state->pending);
+  }
+  free(sat_state->varUnsubsumed);
+  free(sat_state->watches);
+  free(sat_state->binaries);
+  free(sat_state->ternaries);
+  free(sat_state->binaryConflict);
+  free(sat_state->binaryReason);
   free(sat_state->queue);
+  free(sat_state->learnBuffer);
+  free(sat_state->minStack);
+  free(sat_state->minClear);
+  free(sat_state->levelStamp);
   free(sat_state->set);
+  free(sat_state->units);
+  free(sat_state);
   return;
 }
 /******************************************************************************
@@ -293,35 +532,78 @@ void sat_state_free(SatState* sat_state) {
 //returns 1 if unit resolution succeeds, 0 if it finds a contradiction
 BOOLEAN sat_unit_resolution(SatState* sat_state) {
   c2dSize i;
-  BOOLEAN noConflict = 1;
   Lit* lit;
+  Clause* clause;
 
   if (PRINT)
     printInstantiated(sat_state);
 
+  if (sat_state->l>=sat_state->reduceLimit)
+    learnedReduce(sat_state);
+
+  sat_state->conflict = 0;
+  sat_state->setHead = sat_state->setCount;
+  sat_state->xorHead = sat_state->setCount;
+
+  if (sat_state->currentLevel==1 && sat_state->setCount==0) { // unit resolution starts from scratch
+    if (sat_state->empty) { // the empty clause, in the cnf or added
+      sat_state->conflict = 1;
+      conflictFound(NULL, sat_state);
+    }
+    for(i=0; i<sat_state->unitCount && !sat_state->conflict; i++) {
+      clause = sat_state->units[i];
+      lit = CLAUSE_LIT(clause, 0, sat_state);
+      if (LEVEL(lit, sat_state)>0)
+        continue;
+      if (OPP_LEVEL(lit, sat_state)>0) {
+        sat_state->conflict = 1;
+        conflictFound(clause, sat_state);
+      }
+      else
+        literalAssign(lit, (Reason)clause, sat_state);
+    }
+    if (sat_state->xorRows!=NULL && !sat_state->conflict)
+      xorUnits(sat_state);
+  }
+
+  for(i=0; i<sat_state->queueSize; i++) { // pending literals are set first
+    lit = sat_state->queue[i];
+    QUEUED(lit, sat_state) = 0; // back to init
+    if (sat_state->conflict || LEVEL(lit, sat_state)>0)
+      continue;
+    if (OPP_LEVEL(lit, sat_state)>0) { // its reason (if any) is a conflict clause
+      sat_state->conflict = 1;
+      conflictFound(reasonOf(lit, sat_state), sat_state);
+    }
+    else
+      literalAssign(lit, REASON(lit, sat_state), sat_state);
+  }
   for(i=0; i<sat_state->queueSize; i++) {
     lit = sat_state->queue[i];
+    if (LEVEL(lit, sat_state)==0)
+      REASON(lit, sat_state) = 0; //maybe changed but literal not implied 
+  }
+  sat_state->queueSize = 0; //clear all possible implied
+
+  while (!sat_state->conflict) {
+    if (sat_state->setHead==sat_state->setCount) { // the rows once the clauses imply nothing more
+      if (sat_state->xorRows==NULL || sat_state->xorHead==sat_state->setCount)
+        break;
+      xorSet(sat_state->set[sat_state->xorHead++], sat_state);
+      continue;
+    }
+    lit = sat_state->set[sat_state->setHead++];
 
     if (PRINT) {
       printf("Literal %+-4ld is set at level %ld \n", lit->index, sat_state->currentLevel);
       printf("Reason for %-+4ld ------->   ", lit->index);
-      printClause(lit->reason);
+      printClause(reasonOf(lit, sat_state));
       printf("------------------------------------\n");
     }
 
-    noConflict = literalSet(lit, sat_state);
-    if (!noConflict)
-      break;
-  }
-
-  for(i=0; i<sat_state->queueSize; i++) {
-    lit = sat_state->queue[i];
-    lit->inQueue = 0; // back to init
-    if (lit->setLevel==0)
-      lit->reason = NULL; //maybe changed but literal not implied 
+    literalSet(lit, sat_state);
   }
-  sat_state->queueSize = 0; //clear all possible implied
-  return noConflict;
+  return !sat_state->conflict;
 }
 //undoes sat_unit_resolution(), leading to un-instantiating variables that have been instantiated
 //after sat_unit_resolution()
@@ -331,7 +613,7 @@ void sat_undo_unit_resolution(SatState* sat_state) {
 
   for (i=sat_state->setCount; i>0; i--) {
     lit = sat_state->set[i-1];
-    if (lit->setLevel == sat_state->currentLevel) {
+    if (LEVEL(lit, sat_state) == sat_state->currentLevel) {
       literalUnset(lit, sat_state);
       count++;
     }
@@ -340,6 +622,10 @@ void sat_undo_unit_resolution(SatState* sat_state) {
   }
 
   sat_state->setCount -= count;
+  sat_state->setHead = sat_state->setCount;
+  sat_state->xorHead = sat_state->setCount;
+  if (sat_state->setCount<sat_state->targetSame)
+    sat_state->targetSame = sat_state->setCount;
 }
 //returns 1 if the decision level of the sat state equals to the assertion level of clause,
 //0 otherwise
@@ -349,6 +635,10 @@ void sat_undo_unit_resolution(SatState* sat_state) {
 BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state) {
   return sat_state->currentLevel == sat_state->assertionLevel;
 }
+//returns the assertion level of the last clause learned
+c2dSize sat_assertion_level(const Clause* clause, const SatState* sat_state) {
+  return sat_state->assertionLevel;
+}
 
 /******************************************************************************
  * The functions below are already implemented for you and MUST STAY AS IS
@@ -0,0 +1,223 @@
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* incremental solving
+*
+* sat_solve() searches for a model of the cnf under assumptions, on the same
+* sat state from one call to the next, so the learned clauses, the variable
+* activities and the phases carry over to the next queries:
+* --the assumptions are decided first, in order, each at a level of its own
+*   (an assumption already true needs none), the other decisions come from
+*   sat_next_decision() once they are all true
+* --a conflict backjumps to the assertion level of the clause it learns,
+*   which may undo assumptions, they are then decided again
+* --an assumption found false ends the search: the assumptions its opposite
+*   follows from, found by going back over the reasons of the literals set,
+*   are the failed ones
+* --the search restarts after runs of RESTART_UNIT times the terms of the
+*   luby sequence conflicts
+* a conflict at level 1 does not depend on the assumptions, the cnf is then
+* unsatisfiable for every later call too
+* sat_add_clause() adds clauses between the calls, kept with the learned
+* clauses but never deleted
+*******************************************************************************/
+/******************************************************************************
+* the whole search, unit resolution not run yet
+* returns 1 if a model was found, 0 otherwise
+*******************************************************************************/
+BOOLEAN solve(Lit** assumptions, c2dSize count, BOOLEAN* model, Lit** failed, c2dSize* failedCount,
+              SatState* sat_state) {
+  c2dSize i, level, next = 0, run = 0, runs = 0;
+  Lit* lit;
+  Clause* learned;
+  BOOLEAN sat = 0;
+  BOOLEAN done = 0;
+  SolveStats* stats = &sat_state->solveStats;
+
+  stats->solves++;
+  *failedCount = 0;
+  if (sat_state->empty || !sat_unit_resolution(sat_state))
+    done = 1;
+
+  while (!done) {
+    while (next<count && sat_implied_literal(assumptions[next]))
+      next++;
+    lit = next<count ? assumptions[next] : sat_next_decision(sat_state);
+    if (lit==NULL) { // every variable is set
+      if (model!=NULL)
+        for (i=0; i<sat_state->n; i++)
+          model[i] = sat_implied_literal(sat_state->variables[i]->pos);
+      sat = done = 1;
+      break;
+    }
+    if (sat_implied_literal(lit->opp)) { // only an assumption can be false
+      solveFailed(lit, failed, failedCount, sat_state);
+      done = 1;
+      break;
+    }
+
+    learned = sat_decide_literal(lit, sat_state);
+    while (learned!=NULL && !done) {
+      stats->conflicts++;
+      run++;
+      level = sat_assertion_level(learned, sat_state);
+      if (level==0) // the empty clause
+        done = 1;
+      else {
+        sat_backtrack(level, sat_state);
+        next = 0; // some assumptions may be undone
+        learned = sat_assert_clause(learned, sat_state);
+      }
+    }
+    if (!done && run>=RESTART_UNIT*lubyTerm(runs+1)) {
+      stats->restarts++;
+      runs++;
+      run = 0;
+      sat_backtrack(1, sat_state);
+      next = 0;
+    }
+  }
+
+  if (sat==0) {
+    stats->unsatisfiable++;
+    if (*failedCount==0)
+      sat_state->empty = 1;
+  }
+  sat_backtrack(1, sat_state);
+  sat_undo_unit_resolution(sat_state);
+  return sat;
+}
+/******************************************************************************
+* solveFailed :
+* the assumption lit is false, the assumptions the opposite of lit follows
+* from are lit and the decisions met going back over the reasons from it
+* (only assumptions are decided before an assumption is found false)
+* seen marks the literals still to be explained, each is cleared when the
+* backward pass over the set list reaches it
+*******************************************************************************/
+void solveFailed(Lit* lit, Lit** failed, c2dSize* failedCount, SatState* sat_state) {
+  c2dSize i, j;
+  Lit* other;
+  Clause* reason;
+
+  failed[(*failedCount)++] = lit;
+  if (OPP_LEVEL(lit, sat_state)<=1)
+    return; // the cnf alone sets its opposite
+  SEEN(lit->opp, sat_state) = 1;
+  for (i=sat_state->setCount; i>0; i--) {
+    other = sat_state->set[i-1];
+    if (LEVEL(other, sat_state)<=1)
+      break;
+    if (!SEEN(other, sat_state))
+      continue;
+    SEEN(other, sat_state) = 0;
+    reason = reasonOf(other, sat_state);
+    if (reason==NULL) { // an assumption
+      failed[(*failedCount)++] = other;
+      continue;
+    }
+    for (j=0; j<reason->size; j++)
+      if (reason->codes[j]!=other->code && sat_state->litLevel[reason->codes[j]^1]>1)
+        sat_state->litSeen[reason->codes[j]^1] = 1;
+  }
+}
+/******************************************************************************
+* lubyTerm :
+* the i^th term (from 1) of the luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+*******************************************************************************/
+c2dSize lubyTerm(c2dSize i) {
+  c2dSize size = 1;
+
+  while (size<i+1) // the smallest complete part, of 2^k-1 terms, with term i
+    size = 2*size+1;
+  while (size>1) {
+    if (i==size)
+      return (size+1)/2;
+    size /= 2;
+    if (i>size)
+      i -= size;
+  }
+  return 1;
+}
+/******************************************************************************
+* clauseAdd :
+* a clause given between two calls of sat_solve(), its repeated literals are
+* dropped, a tautology is not kept, the empty clause makes the cnf
+* unsatisfiable; the clause goes with the learned ones, with an lbd of 0 so
+* that learnedReduce() keeps it
+* returns 0 if a literal is not one of the variables
+*******************************************************************************/
+BOOLEAN clauseAdd(const c2dLiteral* literals, c2dSize size, SatState* sat_state) {
+  c2dSize i, count = 0;
+  LitCode code;
+  Lit** lits = sat_state->learnBuffer;
+  BOOLEAN* seen = sat_state->litSeen;
+  BOOLEAN tautology = 0;
+  Clause* clause;
+
+  for (i=0; i<size; i++)
+    if (literals[i]==0 || literals[i]>(c2dLiteral)sat_state->n || -literals[i]>(c2dLiteral)sat_state->n)
+      return 0;
+  for (i=0; i<size; i++) {
+    code = LITERAL_CODE(literals[i]);
+    if (seen[code^1])
+      tautology = 1;
+    else if (!seen[code]) {
+      seen[code] = 1;
+      lits[count++] = &sat_state->literals[code];
+    }
+  }
+  for (i=0; i<count; i++)
+    SEEN(lits[i], sat_state) = 0;
+
+  sat_state->solveStats.added++;
+  if (tautology)
+    return 1;
+  if (count==0) {
+    sat_state->empty = 1;
+    return 1;
+  }
+  clause = learnedAdd(count, lits, sat_state);
+  clause->lbd = 0;
+  clauseAttach(clause, sat_state);
+  return 1;
+}
+/******************************************************************************
+* clauseImport :
+* a clause learned by another sat state of the same cnf, at level 1 where unit
+* resolution is done: without its false literals, none of the others is set,
+* so it is attached like a clause learned here, or its literal is set through
+* probeUnit(); it keeps the lbd it was learned with, and is marked imported so
+* that learnedReduce() may delete it even when that lbd is low
+* (a clause of the other sat state has neither repeated literals nor both
+* literals of a variable)
+* returns 0 if a conflict at level 1 follows
+*******************************************************************************/
+BOOLEAN clauseImport(const c2dLiteral* literals, c2dSize size, c2dSize lbd, SatState* sat_state) {
+  c2dSize i, count = 0;
+  Lit* lit;
+  Lit** lits = sat_state->learnBuffer;
+  Clause* clause;
+
+  for (i=0; i<size; i++) {
+    ASSERT_TEST(literals[i]!=0 && literals[i]<=(c2dLiteral)sat_state->n && -literals[i]<=(c2dLiteral)sat_state->n);
+    lit = &sat_state->literals[LITERAL_CODE(literals[i])];
+    if (LEVEL(lit, sat_state)>0)
+      return 1; // true at level 1
+    if (OPP_LEVEL(lit, sat_state)==0)
+      lits[count++] = lit;
+  }
+  if (count==0)
+    return 0;
+  if (count==1)
+    return probeUnit(lits[0], sat_state)==NULL;
+  clause = learnedAdd(count, lits, sat_state);
+  clause->lbd = lbd<count ? lbd : count;
+  clause->imported = 1;
+  clauseAttach(clause, sat_state);
+  return 1;
+}
+/******************************************************************************
+ * end
+ ******************************************************************************/
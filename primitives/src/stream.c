@@ -0,0 +1,350 @@
+#define _DEFAULT_SOURCE
+#include <pthread.h>
+#ifdef SAT_GZIP
+#include <zlib.h>
+#endif
+#ifdef SAT_XZ
+#include <lzma.h>
+#endif
+#ifdef SAT_ZSTD
+#include <zstd.h>
+#endif
+
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* compressed cnf input
+*
+* a thread decompresses the file into a ring of STREAM_CHUNKS chunks while
+* the parser reads the text chunk by chunk, up to the last complete line of
+* what it has, so the decompressed text is never in memory as a whole. the
+* clauses are kept in a ClauseStore until the end of the text
+*******************************************************************************/
+/******************************************************************************
+* the codec of a file, from its first bytes
+*******************************************************************************/
+Codec streamCodec(const unsigned char* data, c2dSize size) {
+  if (size>=2 && data[0]==0x1f && data[1]==0x8b)
+    return CODEC_GZIP;
+  if (size>=6 && memcmp(data, "\xfd" "7zXZ\0", 6)==0)
+    return CODEC_XZ;
+  if (size>=4 && memcmp(data, "\x28\xb5\x2f\xfd", 4)==0)
+    return CODEC_ZSTD;
+  return CODEC_NONE;
+}
+/******************************************************************************
+* the ring between the two threads
+* streamSlot() and streamPush() for the decompressing thread, streamNext()
+* and streamRelease() for the parser
+*******************************************************************************/
+char* streamSlot(Stream* stream) {
+  char* chunk;
+
+  pthread_mutex_lock(&stream->lock);
+  while (stream->tail-stream->head==STREAM_CHUNKS)
+    pthread_cond_wait(&stream->emptied, &stream->lock);
+  chunk = stream->chunks[stream->tail%STREAM_CHUNKS];
+  pthread_mutex_unlock(&stream->lock);
+  return chunk;
+}
+void streamPush(Stream* stream, c2dSize size) {
+  pthread_mutex_lock(&stream->lock);
+  stream->sizes[stream->tail%STREAM_CHUNKS] = size;
+  stream->tail++;
+  pthread_cond_signal(&stream->filled);
+  pthread_mutex_unlock(&stream->lock);
+}
+void streamEnd(Stream* stream, BOOLEAN failed) {
+  pthread_mutex_lock(&stream->lock);
+  stream->done = 1;
+  stream->failed = failed;
+  pthread_cond_signal(&stream->filled);
+  pthread_mutex_unlock(&stream->lock);
+}
+char* streamNext(Stream* stream, c2dSize* size) {
+  char* chunk = NULL;
+
+  pthread_mutex_lock(&stream->lock);
+  while (stream->head==stream->tail && !stream->done)
+    pthread_cond_wait(&stream->filled, &stream->lock);
+  if (stream->head<stream->tail) {
+    chunk = stream->chunks[stream->head%STREAM_CHUNKS];
+    *size = stream->sizes[stream->head%STREAM_CHUNKS];
+  }
+  pthread_mutex_unlock(&stream->lock);
+  return chunk;
+}
+void streamRelease(Stream* stream) {
+  pthread_mutex_lock(&stream->lock);
+  stream->head++;
+  pthread_cond_signal(&stream->emptied);
+  pthread_mutex_unlock(&stream->lock);
+}
+/******************************************************************************
+* compressed bytes, starting with the ones read to find the codec
+*******************************************************************************/
+c2dSize streamRead(Stream* stream, unsigned char* buffer, c2dSize cap) {
+  c2dSize size = stream->prefixSize;
+
+  if (size>0) {
+    memcpy(buffer, stream->prefix, size);
+    stream->prefixSize = 0;
+  }
+  return size+fread(buffer+size, 1, cap-size, stream->in);
+}
+/******************************************************************************
+* one decoder per codec, each fills the chunks of the ring and returns 0
+* when the input is corrupt or truncated
+*******************************************************************************/
+BOOLEAN decodeGzip(Stream* stream, unsigned char* input) {
+#ifdef SAT_GZIP
+  z_stream z;
+  char* chunk = streamSlot(stream);
+  BOOLEAN complete = 0;
+  BOOLEAN eof = 0;
+  int ret;
+
+  memset(&z, 0, sizeof(z));
+  if (inflateInit2(&z, 15+32)!=Z_OK) // gzip or zlib header
+    return 0;
+  z.next_out = (Bytef*)chunk;
+  z.avail_out = STREAM_CHUNK;
+  while (1) {
+    if (z.avail_in==0 && !eof) {
+      z.avail_in = streamRead(stream, input, STREAM_INPUT);
+      z.next_in = input;
+      eof = z.avail_in==0;
+    }
+    ret = inflate(&z, Z_NO_FLUSH);
+    if (ret==Z_STREAM_END) { // gzip files may hold several members
+      complete = 1;
+      inflateReset(&z);
+    }
+    else if (ret==Z_OK)
+      complete = 0;
+    else if (ret!=Z_BUF_ERROR) {
+      complete = 0;
+      break;
+    }
+    if (z.avail_out==0) {
+      streamPush(stream, STREAM_CHUNK);
+      chunk = streamSlot(stream);
+      z.next_out = (Bytef*)chunk;
+      z.avail_out = STREAM_CHUNK;
+    }
+    else if (eof) // nothing more will come out
+      break;
+  }
+  if (z.avail_out<STREAM_CHUNK)
+    streamPush(stream, STREAM_CHUNK-z.avail_out);
+  inflateEnd(&z);
+  return complete;
+#else
+  fprintf(stderr, "ERROR! libsat was built without gzip input (SAT_GZIP).\n");
+  return 0;
+#endif
+}
+BOOLEAN decodeXz(Stream* stream, unsigned char* input) {
+#ifdef SAT_XZ
+  lzma_stream x = LZMA_STREAM_INIT;
+  lzma_action action = LZMA_RUN;
+  char* chunk = streamSlot(stream);
+  lzma_ret ret;
+
+  if (lzma_stream_decoder(&x, UINT64_MAX, LZMA_CONCATENATED)!=LZMA_OK)
+    return 0;
+  x.next_out = (uint8_t*)chunk;
+  x.avail_out = STREAM_CHUNK;
+  while (1) {
+    if (x.avail_in==0 && action==LZMA_RUN) {
+      x.avail_in = streamRead(stream, input, STREAM_INPUT);
+      x.next_in = input;
+      if (x.avail_in==0)
+        action = LZMA_FINISH;
+    }
+    ret = lzma_code(&x, action);
+    if (ret!=LZMA_OK)
+      break;
+    if (x.avail_out==0) {
+      streamPush(stream, STREAM_CHUNK);
+      chunk = streamSlot(stream);
+      x.next_out = (uint8_t*)chunk;
+      x.avail_out = STREAM_CHUNK;
+    }
+  }
+  if (x.avail_out<STREAM_CHUNK)
+    streamPush(stream, STREAM_CHUNK-x.avail_out);
+  lzma_end(&x);
+  return ret==LZMA_STREAM_END;
+#else
+  fprintf(stderr, "ERROR! libsat was built without xz input (SAT_XZ).\n");
+  return 0;
+#endif
+}
+BOOLEAN decodeZstd(Stream* stream, unsigned char* input) {
+#ifdef SAT_ZSTD
+  ZSTD_DCtx* d = ZSTD_createDCtx();
+  ZSTD_inBuffer in = {input, 0, 0};
+  ZSTD_outBuffer out = {streamSlot(stream), STREAM_CHUNK, 0};
+  BOOLEAN full = 0;
+  size_t ret = 0;
+
+  if (d==NULL)
+    return 0;
+  while (1) {
+    if (in.pos==in.size && !full) { // a full chunk may leave output to flush
+      in.size = streamRead(stream, input, STREAM_INPUT);
+      in.pos = 0;
+      if (in.size==0)
+        break;
+    }
+    ret = ZSTD_decompressStream(d, &out, &in); // 0 at the end of a frame
+    if (ZSTD_isError(ret))
+      break;
+    full = out.pos==out.size;
+    if (full) {
+      streamPush(stream, out.pos);
+      out.dst = streamSlot(stream);
+      out.pos = 0;
+    }
+  }
+  if (out.pos>0)
+    streamPush(stream, out.pos);
+  ZSTD_freeDCtx(d);
+  return ret==0;
+#else
+  fprintf(stderr, "ERROR! libsat was built without zstd input (SAT_ZSTD).\n");
+  return 0;
+#endif
+}
+/******************************************************************************
+* the decompressing thread
+*******************************************************************************/
+void* streamDecode(void* arg) {
+  Stream* stream = (Stream*)arg;
+  unsigned char* input = (unsigned char*)malloc(STREAM_INPUT);
+  BOOLEAN done = 0;
+
+  if (stream->codec==CODEC_GZIP)
+    done = decodeGzip(stream, input);
+  else if (stream->codec==CODEC_XZ)
+    done = decodeXz(stream, input);
+  else if (stream->codec==CODEC_ZSTD)
+    done = decodeZstd(stream, input);
+  free(input);
+  streamEnd(stream, !done);
+  return NULL;
+}
+/******************************************************************************
+* the parser, on text that ends at a line end so no token is cut; the
+* problem line, the clause being read and the clauses read so far are
+* kept in the TextParse between calls; it stops at text that is not a
+* clause (the % line of some files)
+*******************************************************************************/
+void streamParse(char* in, TextParse* parse, SatState* sat_state) {
+  c2dSize parsedNum;
+  char sign;
+
+  while (!parse->stop) {
+    skipWhitespace(&in);
+    if (*in == 0)
+      break;
+    else if (*in == 'c')  // comment line
+      skipLine(&in);
+    else if (!parse->header) {
+      if (*in != 'p')
+        fprintf(stderr, "ERROR! Missing problem line.\n"), exit(-1);
+      parseProblem(&in, sat_state);
+      parse->header = 1;
+      storeReserve(&parse->store, sat_state->m, 3*sat_state->m);
+    }
+    else if (*in == '-' || (*in >= '0' && *in <= '9')) { // a 0 with no literal before it is the empty clause
+      parse->open = 1;
+      sign = getSign(&in);
+      parsedNum = parseNum(&in);
+      if (parsedNum == 0) { // end of this clause
+        storeClose(&parse->store, sat_state);
+        parse->open = 0;
+      }
+      else if (parsedNum > sat_state->n)
+        fprintf(stderr, "ERROR! Variable %ld out of range in parsing.\n", parsedNum), exit(-1);
+      else
+        storeAdd(&parse->store, 2*(parsedNum-1)+(sign==0), sat_state);
+    }
+    else
+      parse->stop = 1;
+  }
+}
+/******************************************************************************
+* load a compressed cnf, prefix holds the bytes already read from in
+* returns the bytes of decompressed text
+*******************************************************************************/
+c2dSize streamLoad(FILE* in, Codec codec, const unsigned char* prefix, c2dSize prefixSize, SatState* sat_state) {
+  Stream stream;
+  TextParse parse;
+  pthread_t thread;
+  char* chunk;
+  char* text;
+  char keep;
+  c2dSize i;
+  c2dSize size;
+  c2dSize used = 0; // bytes of text, the tail after the last line end is kept for the next chunk
+  c2dSize end;
+  c2dSize cap = 2*STREAM_CHUNK;
+  c2dSize total = 0;
+
+  memset(&stream, 0, sizeof(stream));
+  stream.in = in;
+  stream.codec = codec;
+  memcpy(stream.prefix, prefix, prefixSize);
+  stream.prefixSize = prefixSize;
+  for (i=0; i<STREAM_CHUNKS; i++)
+    stream.chunks[i] = (char*)malloc(STREAM_CHUNK);
+  pthread_mutex_init(&stream.lock, NULL);
+  pthread_cond_init(&stream.filled, NULL);
+  pthread_cond_init(&stream.emptied, NULL);
+  memset(&parse, 0, sizeof(parse));
+  storeInit(&parse.store);
+  text = (char*)malloc(cap);
+
+  pthread_create(&thread, NULL, streamDecode, &stream);
+  while ((chunk = streamNext(&stream, &size))!=NULL) {
+    if (used+size+1>cap) { // only when a line is longer than a chunk
+      cap = 2*(used+size+1);
+      text = realloc(text, cap);
+    }
+    memcpy(text+used, chunk, size);
+    streamRelease(&stream);
+    used += size;
+    total += size;
+    for (end=used; end>0 && text[end-1]!='\n'; end--);
+    if (end==0)
+      continue;
+    keep = text[end];
+    text[end] = 0;
+    streamParse(text, &parse, sat_state);
+    text[end] = keep;
+    used -= end;
+    memmove(text, text+end, used);
+  }
+  pthread_join(thread, NULL);
+  if (stream.failed)
+    fprintf(stderr, "ERROR! Corrupt or truncated compressed input.\n"), exit(-1);
+  text[used] = 0;
+  streamParse(text, &parse, sat_state);
+  if (!parse.header)
+    fprintf(stderr, "ERROR! Missing problem line.\n"), exit(-1);
+  storeDrop(&parse.store, sat_state); // a last clause without its 0
+  sat_state->m = parse.store.count; // the clauses of the file, whatever the problem line says
+  storeBuild(&parse.store, sat_state);
+
+  storeFree(&parse.store);
+  free(text);
+  for (i=0; i<STREAM_CHUNKS; i++)
+    free(stream.chunks[i]);
+  pthread_mutex_destroy(&stream.lock);
+  pthread_cond_destroy(&stream.filled);
+  pthread_cond_destroy(&stream.emptied);
+  return total;
+}
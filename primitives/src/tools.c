@@ -1,3 +1,9 @@
+#define _DEFAULT_SOURCE  // mmap and MAP_ANONYMOUS under -std=c99
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <time.h>
+
 #include "sat_api.h"
 #include "tools.h"
 
@@ -5,116 +11,286 @@
 * unit resolution
 **********************************************************************/
 /******************************************************************************
-* literalSet, set the literal to be true and check new subsumed clause and new
-* possibility for unit resolution
+* literalAssign, set the literal to be true at current level and put it on the
+* set list, its consequences are found later by literalSet
 *******************************************************************************/
-BOOLEAN literalSet(Lit* lit, SatState* sat_state) {
-  c2dSize i;
-  BOOLEAN noConflict = 1;
-  Clause* clause;
-
+void literalAssign(Lit* lit, Reason reason, SatState* sat_state) {
   ASSERT_TEST(!sat_implied_literal(lit)); // this literal should not be set 
   ASSERT_TEST(!sat_implied_literal(lit->opp)); // opposite literal should not be set (conflict testing in a different way)
 
-  lit->setLevel = sat_state->currentLevel; // formally set the literal to true only here!!!!
+  LEVEL(lit, sat_state) = sat_state->currentLevel;
+  REASON(lit, sat_state) = reason;
   sat_state->set[sat_state->setCount++] = lit;
+  if (sat_state->xorRows!=NULL)
+    xorAssign(lit->code, sat_state);
+  if (sat_state->card!=NULL)
+    cardAssign(lit->code, sat_state);
+}
+/******************************************************************************
+* literalSet, the literal is already assigned, check new subsumed clause and
+* visit the clauses of its opposite for new possibility of unit resolution:
+* binary and ternary clauses through their own lists, the longer ones through
+* the watches
+*******************************************************************************/
+BOOLEAN literalSet(Lit* lit, SatState* sat_state) {
+  c2dSize i, j, size;
+  Clause* clause;
+  WatchList* watch;
+
+  ASSERT_TEST(LEVEL(lit, sat_state)==sat_state->currentLevel); // assigned by literalAssign at this level
 
   for (i=0; i<lit->occurSize; i++) { // set every clause that has literal l and not already subsumed to subsumed
     clause = lit->occurIn[i];
     if (clause->setLevel==0)
-      clause->setLevel = sat_state->currentLevel;
+      clauseSubsume(clause, sat_state);
   }
   
-  lit = lit->opp; // deal with the opposite literal occurrence 
-  for (i=0; i<lit->occurSize; i++) { // update falseLit for every clause that has opposite literal l
-    clause = lit->occurIn[i];
-    clause->falseLit++;
-    if (PRINT) {
-      printf("C %-4ld\tFreeLit\t\t%ld", clause->index, clause->size-clause->falseLit);
-      if (clause->setLevel>0)
-        printf("\t\tSubsumed\t\t\n");
-      else
-        printf("\t\t        \t\t\n");
-    }
+  if (sat_state->card!=NULL && !cardSet(lit, sat_state))
+    return 0;
 
-    if (noConflict) // no conflict up till now
-      noConflict = clauseTest(clause, sat_state); // test whether the new clause cause conflict
-    else {
-      if (PRINT)
-        printf("No clauseTest here due to existing of conflict\n");
-      continue; // continue here to keep updating the falseLit of other clauses
-    }
+  lit = lit->opp; // only clauses with the opposite literal may become unit
+  if (!binaryTest(lit, sat_state) || !ternaryTest(lit, sat_state))
+    return 0;
+
+  watch = &sat_state->watches[lit->code];
+  size = watch->size;
+  for (i=0, j=0; i<size; i++) {
+    clause = watch->clauses[i]; // a clause learned on a conflict may grow the list meanwhile
+    if (sat_state->conflict || clauseTest(clause, lit, sat_state))
+      watch->clauses[j++] = clause; // keep the remaining watches as they are after a conflict
   }
+  for (; i<watch->size; i++) // watches added by the learned clause
+    watch->clauses[j++] = watch->clauses[i];
+  watch->size = j;
+
   if (PRINT)
     printf("------------------------------------\n");
-  return noConflict;
+  return !sat_state->conflict;
+}
+/******************************************************************************
+* binaryTest       :
+* lit became false, the other literal of each of its binary clauses is implied,
+* with a tagged reason that names lit
+* a conflict stands for the clause in sat_state->binaryConflict
+* returns 0 on a conflict
+*******************************************************************************/
+BOOLEAN binaryTest(Lit* lit, SatState* sat_state) {
+  c2dSize i;
+  LitCode other;
+  BinaryList* list = &sat_state->binaries[lit->code];
+  const c2dSize* level = sat_state->litLevel;
+
+  for (i=0; i<list->size; i++) {
+    other = list->others[i];
+    if (level[other]>0)
+      continue;
+    if (level[other^1]>0) { // a conflict clause
+      sat_state->binaryConflict->codes[0] = lit->code;
+      sat_state->binaryConflict->codes[1] = other;
+      sat_state->conflict = 1;
+      conflictFound(sat_state->binaryConflict, sat_state); // may grow this list, stop here
+      return 0;
+    }
+    literalAssign(&sat_state->literals[other], REASON_BINARY(lit->code), sat_state);
+  }
+  return 1;
+}
+/******************************************************************************
+* ternaryTest       :
+* lit became false, every ternary clause of lit is checked through the other
+* two literals kept in the list, the clause itself is only used as a reason
+* returns 0 on a conflict
+*******************************************************************************/
+BOOLEAN ternaryTest(Lit* lit, SatState* sat_state) {
+  c2dSize i;
+  Ternary* entry;
+  TernaryList* list = &sat_state->ternaries[lit->code];
+  const c2dSize* level = sat_state->litLevel;
+
+  for (i=0; i<list->size; i++) {
+    entry = &list->entries[i];
+    if (level[entry->a]>0 || level[entry->b]>0)
+      continue; // subsumed
+    if (level[entry->a^1]>0) {
+      if (level[entry->b^1]>0) { // a conflict clause
+        sat_state->conflict = 1;
+        conflictFound(entry->clause, sat_state); // may grow this list, stop here
+        return 0;
+      }
+      literalAssign(&sat_state->literals[entry->b], (Reason)entry->clause, sat_state);
+    }
+    else if (level[entry->b^1]>0)
+      literalAssign(&sat_state->literals[entry->a], (Reason)entry->clause, sat_state);
+  }
+  return 1;
+}
+/******************************************************************************
+* reasonOf       :
+* the clause that implied lit, NULL for a decision
+* a tagged binary reason is spelled out in sat_state->binaryReason, which is
+* valid until the next call
+*******************************************************************************/
+Clause* reasonOf(Lit* lit, SatState* sat_state) {
+  Reason reason = REASON(lit, sat_state);
+
+  if (!REASON_IS_BINARY(reason))
+    return (Clause*)reason;
+  sat_state->binaryReason->codes[0] = lit->code;
+  sat_state->binaryReason->codes[1] = REASON_CODE(reason);
+  return sat_state->binaryReason;
 }
 /******************************************************************************
 * clauseTest       :
 * used for unit-resolution
-* test a clause is conflict or not, or unit-resolution can be done, do the resolution and update information
+* the watched literal lit of clause became false, find another literal to watch,
+* otherwise the clause is unit or a conflict, do the resolution and update information
+* returns 1 if the clause still watches lit, 0 if the watch moved to another literal
 *******************************************************************************/
-BOOLEAN clauseTest(Clause* clause, SatState* sat_state) {
-  if (clause->setLevel!=0)
-    return 1; // no conflict if clause is already subsumed
-  else if (clause->size == clause->falseLit) { // a conflict clause
+BOOLEAN clauseTest(Clause* clause, Lit* lit, SatState* sat_state) {
+  c2dSize i;
+  Lit* other;
+  LitCode* codes = clause->codes;
+  const c2dSize* level = sat_state->litLevel;
+
+  if (codes[0]==lit->code) { // keep the false watch at codes[1]
+    codes[0] = codes[1];
+    codes[1] = lit->code;
+  }
+  if (level[codes[0]]>0)
+    return 1; // no conflict if clause is already subsumed by the other watch
+
+  for (i=2; i<clause->size; i++) {
+    if (level[codes[i]^1]==0) { // a literal not set to false, watch it instead
+      codes[1] = codes[i];
+      codes[i] = lit->code;
+      lit_addWatch(codes[1], clause, sat_state);
+      return 0;
+    }
+  }
+
+  other = &sat_state->literals[codes[0]];
+  if (level[codes[0]^1]>0) { // a conflict clause
     if (PRINT) {
       printf("~~~~~~~~~~~~~~ Conflict ~~~~~~~~~~~~~~\n");
       printClause(clause);
     }
-    switch (CON) {
-      case 0:
-        firstUIP(clause, sat_state);
-        break;
-      case 1:
-        conflictSet(clause, sat_state);  // find the learned clause   
-        break;
-    }
-    return 0;
+    sat_state->conflict = 1;
+    conflictFound(clause, sat_state);
   }
-  else if (clause->size == clause->falseLit+1) { // a clause where unit-resolution can be done 
-    Lit* lit;
-    c2dSize i;
+  else { // a clause where unit-resolution can be done, other is the only "free" literal
+    literalAssign(other, (Reason)clause, sat_state);  // update reason for implied literal -- for conflict driven
+    if (PRINT)
+      printf("Lit %-+4ld is implied by C %-4ld\n", other->index, clause->index);
+  }
+  return 1;
+}
+/******************************************************************************
+* conflictFound       :
+* every literal of clause is false, learn a clause using the method set by CON
+* a conflict at level 1 can not be asserted anywhere, the learned clause is empty
+*******************************************************************************/
+void conflictFound(Clause* clause, SatState* sat_state) {
+  if (sat_state->currentLevel==1) {
+    learnedAdd(0, NULL, sat_state);
+    sat_state->learned = NULL;
+    sat_state->assertionLevel = 0; // never at assertion level, the cnf is inconsistent
+    return;
+  }
+  switch (CON) {
+    case 0:
+      firstUIP(clause, sat_state);
+      break;
+    case 1:
+      conflictSet(clause, sat_state);  // find the learned clause   
+      break;
+  }
+}
+/******************************************************************************
+* learnedWatch()       :
+* find the assertion level of a learned clause and let it take part in unit
+* resolution: codes[0] is the asserting literal sat_state->learned, codes[1] is
+* a literal set at the assertion level, so both watches stay right once the
+* state backtracks to the assertion level
+*******************************************************************************/
+void learnedWatch(Clause* clause, SatState* sat_state) {
+  c2dSize i, level;
+  LitCode tmp;
+  LitCode* codes = clause->codes;
 
-    ASSERT_TEST(clause->size>=1); 
-    lit = clause->lits[0];
+  REASON(sat_state->learned, sat_state) = (Reason)clause;
+  sat_state->assertionLevel = 1; // initial value
 
-    if (DEBUG) {  // debug mode, go through all literals in clause
-      c2dSize tmp = 0;
-      for (i=0; i<clause->size; i++) {
-        if (clause->lits[i]->opp->setLevel==0)
-          lit = clause->lits[i]; // the only "free" literal in this clause
-        else
-          tmp++;
-      }
-      ASSERT_TEST(tmp==clause->size-1); // test if there are clause->size-1 literals set to 'false' 
-    }
-    else {
-      for (i=0; i<clause->size; i++) {
-        if (clause->lits[i]->opp->setLevel==0) {
-          lit = clause->lits[i]; // the only "free" literal in this clause
-          break;
-        }
-      }
-    }
-    // update reason for implied literal -- for conflict driven
-    if (!lit->inQueue && !lit->opp->inQueue) { //didn't deal with,  the literal is unset and not in the tosetList or the opp lit is already in
-      lit->reason = clause;
-      lit->inQueue = 1; // put the lit to the tosetList
-      sat_state->queue[sat_state->queueSize++] = lit;
-      //sat_state->queue[sat_state->queueSize++] = lit;
-      if (PRINT)
-        printf("Lit %-+4ld is put into the resolution list\n", lit->index);
+  for (i=0; i<clause->size; i++) {
+    if (codes[i]==sat_state->learned->code) {
+      codes[i] = codes[0];
+      codes[0] = sat_state->learned->code;
+      break;
     }
-    else {
-      if (PRINT)
-        printf("Lit %-+4ld is discard due to redundancy \n", lit->index);
-      ASSERT_TEST(lit->setLevel==sat_state->currentLevel || lit->setLevel==0); // or it can only be set at this level before or is still in the tosetList
+  }
+  for (i=1; i<clause->size; i++) {
+    level = sat_state->litLevel[codes[i]^1];
+    if (level<sat_state->currentLevel && sat_state->assertionLevel<level) {
+      sat_state->assertionLevel = level;
+      tmp = codes[i];
+      codes[i] = codes[1];
+      codes[1] = tmp;
     }
-    return 1;
   }
-  else // ordinary clause, no more information
-    return 1;
+
+  clause->setLevel = sat_state->assertionLevel;
+  clauseAttach(clause, sat_state);
+}
+/******************************************************************************
+* clauseAttach()       :
+* let a clause take part in unit resolution: unit clauses are kept apart,
+* binary and ternary clauses go to the lists of each of their literals, longer
+* clauses watch codes[0] and codes[1]
+*******************************************************************************/
+void clauseAttach(Clause* clause, SatState* sat_state) {
+  LitCode* codes = clause->codes;
+
+  switch (clause->size) {
+    case 0:
+      break;
+    case 1:
+      unitAdd(clause, sat_state);
+      break;
+    case 2:
+      lit_addBinary(codes[0], codes[1], sat_state);
+      lit_addBinary(codes[1], codes[0], sat_state);
+      break;
+    case 3:
+      lit_addTernary(codes[0], codes[1], codes[2], clause, sat_state);
+      lit_addTernary(codes[1], codes[0], codes[2], clause, sat_state);
+      lit_addTernary(codes[2], codes[0], codes[1], clause, sat_state);
+      break;
+    default:
+      lit_addWatch(codes[0], clause, sat_state);
+      lit_addWatch(codes[1], clause, sat_state);
+  }
+}
+/******************************************************************************
+* clauseReserve, for the first parsing pass: count in cap what clauseAttach
+* will add to each list, so the lists are allocated once at their size
+*******************************************************************************/
+void clauseReserve(LitCode* codes, c2dSize size, SatState* sat_state) {
+  switch (size) {
+    case 0:
+    case 1:
+      break;
+    case 2:
+      sat_state->binaries[codes[0]].cap++;
+      sat_state->binaries[codes[1]].cap++;
+      break;
+    case 3:
+      sat_state->ternaries[codes[0]].cap++;
+      sat_state->ternaries[codes[1]].cap++;
+      sat_state->ternaries[codes[2]].cap++;
+      break;
+    default:
+      sat_state->watches[codes[0]].cap++;
+      sat_state->watches[codes[1]].cap++;
+  }
 }
 /******************************************************************************
 * conflictSet()       :
@@ -136,7 +312,7 @@ void conflictSet(Clause* clause, SatState* sat_state) {
   
   for (i=0; i<clause->size; i++) {
     head = (LitLink*)malloc(sizeof(LitLink));
-    head->lit = clause->lits[i]->opp;  // here notice it is the opposite literal in the current conflict clause
+    head->lit = CLAUSE_LIT(clause, i, sat_state)->opp;  // here notice it is the opposite literal in the current conflict clause
     head->next = tmp;
     tmp = head;
   }
@@ -149,33 +325,33 @@ void conflictSet(Clause* clause, SatState* sat_state) {
     if (PRINT)
       printf("%ld\t", lit->index);
 
-    ASSERT_TEST(lit->setLevel<=sat_state->currentLevel); // l must be set in level not greater than current sat state level 
+    ASSERT_TEST(LEVEL(lit, sat_state)<=sat_state->currentLevel); // l must be set in level not greater than current sat state level 
     
-    if (lit->setLevel < sat_state->currentLevel) {  // literal from lower level
-      if (lit->seen==0) { // already visited before
+    if (LEVEL(lit, sat_state) < sat_state->currentLevel) {  // literal from lower level
+      if (SEEN(lit, sat_state)==0) { // already visited before
         size++;
         learned = realloc(learned, sizeof(Lit*)*size);
         learned[size-1] = lit->opp;
-        lit->seen = 1; // set it to has already added
+        SEEN(lit, sat_state) = 1; // set it to has already added
       }
       if (PRINT)
         printf("\n");
     }
     else {  // literal from current level
-      if (lit->seen == 1) {  // already visited before
+      if (SEEN(lit, sat_state) == 1) {  // already visited before
         if (PRINT)
           printf("Search tree pruned here.\n");
       }
       else {
-        lit->seen = 1;  // set it to already visited
+        SEEN(lit, sat_state) = 1;  // set it to already visited
         // add cause of l, in deep first manner
-        ctmp = lit->reason;
+        ctmp = reasonOf(lit, sat_state);
         if (ctmp!=NULL) {  // if not at the decision of this level, put it's cause to the list for visiting
           for (i=0; i<ctmp->size; i++) {
-            if (ctmp->lits[i]==lit)  // l itself in the cause, ignore
+            if (CLAUSE_LIT(ctmp, i, sat_state)==lit)  // l itself in the cause, ignore
               continue;
             tmp = (LitLink*)malloc(sizeof(LitLink));
-            tmp->lit = ctmp->lits[i]->opp;  // here notice it is the opposite literal in the current conflict clause
+            tmp->lit = CLAUSE_LIT(ctmp, i, sat_state)->opp;  // here notice it is the opposite literal in the current conflict clause
             tmp->next = head;
             head = tmp;  // add a new element to the head of the link-list
           }
@@ -193,22 +369,9 @@ void conflictSet(Clause* clause, SatState* sat_state) {
     tmp = head; // take the element from the head of the link-list 
   }
 
-  sat_state->l++;
-  sat_state->delta = realloc(sat_state->delta, sizeof(Clause*)*(sat_state->m+sat_state->l));
-  ctmp = clause_new(sat_state->m+sat_state->l, size, learned);
-
-  sat_state->delta[sat_state->m+sat_state->l-1] = ctmp;
-
-  sat_state->learned->reason = sat_state->delta[sat_state->m+sat_state->l-1];
-
-  sat_state->assertionLevel = 1; // initial value
-  for (i=0; i<size; i++) {
-    //lit_addInClause(learned[i], sat_state->m+sat_state->l); //add the clause index to variables it mentioned
-    if (learned[i]->opp->setLevel<sat_state->currentLevel && sat_state->assertionLevel<learned[i]->opp->setLevel)
-      sat_state->assertionLevel = learned[i]->opp->setLevel;
-  }
-
-  ctmp->setLevel = sat_state->assertionLevel;
+  ctmp = learnedAdd(size, learned, sat_state);
+  free(learned);
+  learnedWatch(ctmp, sat_state);
 
   if (PRINT) {
     // printf("Assertion Level: %ld.\n", sat_state->assertionLevel);
@@ -217,35 +380,30 @@ void conflictSet(Clause* clause, SatState* sat_state) {
     printf("Assertion Level: %4ld\n", sat_state->assertionLevel);
     printf("------------------------------------\n");
   }
-  // need to reset lit->seen
-  for (i=0; i<sat_state->n; i++) {
-    sat_state->variables[i]->pos->seen = 0;
-    sat_state->variables[i]->neg->seen = 0;
-  }
+  // need to reset seen
+  memset(sat_state->litSeen, 0, sizeof(BOOLEAN)*2*sat_state->n);
 }
 /******************************************************************************
 * firstUIP()       :
 * asserting clause use first UIP
+* one backward pass over the set list resolves the conflict with the reasons of
+* the literals set at the current level. seen marks the (false) literals already
+* in the learned clause, pending counts those of the current level that are not
+* resolved yet, the first UIP is reached when pending drops to 0
+* literals set at level 1 hold in every state, they are left out of the clause
+* the clause is built in sat_state->learnBuffer, only the final clause is allocated
 *******************************************************************************/
 void firstUIP(Clause* clause, SatState* sat_state) {
-  c2dSize atCurrentLevel;
-  Clause *conflict, *reason;
-  Lit* focus;
-  Lit* tmp;
-  Lit** lits = (Lit**)malloc(sizeof(Lit*)*clause->size);
-
-  c2dSize i, j;
-  c2dLiteral index;
-
-  BOOLEAN jump;
-
-  for (i=0; i<clause->size; i++)  // deep copy, conflict = clause
-    lits[i] = clause->lits[i];
-
-  sat_state->l++;
-  sat_state->delta = realloc(sat_state->delta, sizeof(Clause*)*(sat_state->m+sat_state->l));
-  conflict = clause_new(sat_state->m+sat_state->l, clause->size, lits);
-  sat_state->delta[sat_state->m+sat_state->l-1] = conflict;
+  c2dSize i, size = 1; // learnBuffer[0] is kept for the asserting literal
+  c2dSize pending = 0;
+  c2dSize trail = sat_state->setCount;
+  Lit** buffer = sat_state->learnBuffer;
+  Lit* focus = NULL; // the literal resolved on, NULL for the conflict clause
+  LitCode code;
+  BOOLEAN* seen = sat_state->litSeen;
+  const c2dSize* level = sat_state->litLevel;
+  Clause* reason = clause;
+  Clause* conflict;
 
   if (PRINT) {
     for (i=0; i<sat_state->setCount; i++)
@@ -253,94 +411,290 @@ void firstUIP(Clause* clause, SatState* sat_state) {
     printf("\n-------------------------------------\n");
   }
 
-  for (i=sat_state->setCount; i>0; i--) {
-    focus = sat_state->set[i-1];
-    reason = focus->reason;
-
-    jump = 1;   // test if current conflict contains focus
-    for (j=0; j<conflict->size; j++) {
-      if (conflict->lits[j] == focus->opp) {
-        jump = 0;
-        break;
-      }
-    }
-    if (jump)
-      continue;
-    
-    index = -1;
-    atCurrentLevel = 0;
-
-    for (j=0; j<conflict->size; j++) {
-      if (conflict->lits[j]->opp->setLevel == sat_state->currentLevel) {
-        atCurrentLevel++;
-      } // check if the conflict is the 1UIP now
-      
-      if (conflict->lits[j] != focus->opp) {
-        conflict->lits[j]->seen = 1; // mark exist
-      }
-      else // the resolution literal, keep the index
-        index = j;
-    }
-    ASSERT_TEST(index>=0);
-    if (atCurrentLevel==1) { //todo
-      sat_state->learned = conflict->lits[index];
-      for (j=0; j<conflict->size; j++)
-        conflict->lits[j]->seen = 0;
-      break;
+  while (1) {
+    ASSERT_TEST(reason!=NULL); // only the decision has no reason, and it is always a UIP
+    if (reason->index>sat_state->m)
+      clauseBump(reason, sat_state);
+    for (i=0; i<reason->size; i++) {
+      code = reason->codes[i];
+      if (seen[code] || level[code^1]<=1) // focus itself is true, so skipped here too
+        continue;
+      seen[code] = 1;
+      varBump(code>>1, sat_state);
+      if (level[code^1]==sat_state->currentLevel)
+        pending++;
+      else
+        buffer[size++] = &sat_state->literals[code];
     }
 
-    if (PRINT) {
-      printf("(%ld)\t\t\t\t\t\t", atCurrentLevel);
-      printClause(conflict);
-      printf("On %+-4ld with \t", focus->index);
-      printClause(reason);
-      printf("-------------------------------------------\n");
-      //printf("Index: %ld\n", index);
-    }
-    
+    do { // the latest literal of the clause set at the current level
+      focus = sat_state->set[--trail];
+    } while (!seen[focus->code^1]);
+    seen[focus->code^1] = 0;
 
-    tmp = conflict->lits[index];
-    conflict->lits[index] = conflict->lits[conflict->size-1];
-    conflict->lits[conflict->size-1] = tmp;   // swap the focus to the last one at conflict
-
-    conflict->size--;
-    conflict->lits = realloc(conflict->lits, sizeof(Lit*)*conflict->size); // then delete existence of focus
-
-    for (j=0; j<reason->size; j++) {
-      if (!reason->lits[j]->seen && reason->lits[j]!=focus) {
-        conflict->size++;
-        conflict->lits = realloc(conflict->lits, sizeof(Lit*)*conflict->size);
-        conflict->lits[conflict->size-1] = reason->lits[j];
-      }
+    if (PRINT) {
+      printf("(%ld)\tOn %+-4ld with \t", pending, focus->index);
+      printClause(reasonOf(focus, sat_state));
     }
 
-    for (j=0; j<conflict->size; j++)
-      conflict->lits[j]->seen = 0; 
+    if (--pending==0)
+      break;
+    reason = reasonOf(focus, sat_state);
   }
 
-  sat_state->learned->reason = conflict;
+  sat_state->learned = buffer[0] = focus->opp;
+  varDecay(sat_state);
+  for (i=1; i<size; i++)
+    sat_state->minClear[i-1] = buffer[i];
+  sat_state->minClearCount = size-1;
 
-  sat_state->assertionLevel = 1; // initial value
-  for (i=0; i<conflict->size; i++) {
-    //lit_addInClause(learned[i], sat_state->m+sat_state->l); //add the clause index to variables it mentioned
-    if (conflict->lits[i]->opp->setLevel<sat_state->currentLevel && sat_state->assertionLevel<conflict->lits[i]->opp->setLevel)
-      sat_state->assertionLevel = conflict->lits[i]->opp->setLevel;
-  }
+  if (MINIMIZE)
+    size = learnedMinimize(buffer, size, sat_state);
 
-  conflict->setLevel = sat_state->assertionLevel;
+  for (i=0; i<sat_state->minClearCount; i++)
+    SEEN(sat_state->minClear[i], sat_state) = 0;
 
+  conflict = learnedAdd(size, buffer, sat_state);
+  learnedWatch(conflict, sat_state);
 
   if (PRINT) {
-    // printf("Assertion Level: %ld.\n", sat_state->assertionLevel);
     printf("~~~~~~~~~~~~~~ Learned ~~~~~~~~~~~~~~\n");
     printClause(conflict);
-    //printClause(sat_state->delta[sat_state->m+sat_state->l-1]);
     printf("Assertion Level: %4ld\n", sat_state->assertionLevel);
     printf("------------------------------------\n");
   }
+}
+/******************************************************************************
+* learnedMinimize()       :
+* remove from the learned clause lits[0..size-1] the literals implied by the
+* rest of it, lits[0] is the asserting literal and always stays
+* a literal is removed when every other literal of its reason is in the clause
+* (local) or is itself removed by the same rule (recursive, MINIMIZE 2)
+* seen marks the literals of the clause, the new size is returned
+*******************************************************************************/
+c2dSize learnedMinimize(Lit** lits, c2dSize size, SatState* sat_state) {
+  c2dSize i, j, k;
+  c2dSize levels = 0;
+  Lit* lit;
+  Clause* reason;
+  BOOLEAN local;
 
+  for (i=1; i<size; i++)
+    levels |= LEVEL_BIT(OPP_LEVEL(lits[i], sat_state));
 
-  
+  for (i=1, j=1; i<size; i++) {
+    reason = reasonOf(lits[i]->opp, sat_state);
+    if (reason==NULL) {  // a decision can not be removed
+      lits[j++] = lits[i];
+      continue;
+    }
+    local = 1;
+    for (k=0; k<reason->size && local; k++)
+      if ((lit = CLAUSE_LIT(reason, k, sat_state))!=lits[i]->opp && !SEEN(lit, sat_state) && OPP_LEVEL(lit, sat_state)>1)
+        local = 0;
+    if (local)
+      sat_state->minLocal++;
+    else if (MINIMIZE==2 && litRedundant(lits[i], levels, sat_state))
+      sat_state->minRecursive++;
+    else
+      lits[j++] = lits[i];
+  }
+
+  if (PRINT)
+    printf("Minimized: %ld -> %ld\n", size, j);
+  return j;
+}
+/******************************************************************************
+* litRedundant()       :
+* depth first search over the reasons of the false literal lit, it is redundant
+* when every chain ends in literals of the learned clause or set at level 1
+* a literal set at a level missing from levels (or a decision) can not be
+* implied by the clause, so the search fails there
+* the literals found redundant keep their seen mark for the next searches,
+* the marks of a failed search are undone
+*******************************************************************************/
+BOOLEAN litRedundant(Lit* lit, c2dSize levels, SatState* sat_state) {
+  c2dSize i, top = 1;
+  c2dSize clear = sat_state->minClearCount;
+  Lit** stack = sat_state->minStack;
+  Lit *tmp, *implied;
+  Clause* reason;
+
+  stack[0] = lit;
+  while (top>0) {
+    implied = stack[--top]->opp;
+    reason = reasonOf(implied, sat_state);
+    for (i=0; i<reason->size; i++) {
+      tmp = CLAUSE_LIT(reason, i, sat_state);
+      if (tmp==implied || SEEN(tmp, sat_state) || OPP_LEVEL(tmp, sat_state)<=1)
+        continue;
+      if (REASON(tmp->opp, sat_state)==0 || !(LEVEL_BIT(OPP_LEVEL(tmp, sat_state)) & levels)) {
+        for (; sat_state->minClearCount>clear; sat_state->minClearCount--)
+          SEEN(sat_state->minClear[sat_state->minClearCount-1], sat_state) = 0;
+        return 0;
+      }
+      SEEN(tmp, sat_state) = 1;
+      stack[top++] = tmp;
+      sat_state->minClear[sat_state->minClearCount++] = tmp;
+    }
+  }
+  return 1;
+}
+/******************************************************************************
+* learnedAdd()       :
+* copy the learned clause lits[0..size-1] and append it to delta, which grows
+* geometrically
+* the new clause gets the current clause activity and its lbd
+*******************************************************************************/
+Clause* learnedAdd(c2dSize size, Lit** lits, SatState* sat_state) {
+  Clause* clause;
+
+  if (sat_state->m+sat_state->l==sat_state->deltaCap) {
+    sat_state->deltaCap *= 2;
+    sat_state->delta = (Clause**)realloc(sat_state->delta, sizeof(Clause*)*sat_state->deltaCap);
+  }
+  sat_state->l++;
+  clause = clause_new(sat_state->m+sat_state->l, size, lits, sat_state);
+  sat_state->delta[sat_state->m+sat_state->l-1] = clause;
+
+  clause->lbd = clauseLbd(clause, sat_state);
+  clause->activity = sat_state->clauseInc;
+  sat_state->clauseInc /= CLAUSE_DECAY;
+  if (sat_state->clauseInc>1e20)
+    activityRescale(sat_state);
+  return clause;
+}
+/******************************************************************************
+* clauseLbd()       :
+* the number of distinct levels among the (set) literals of clause
+*******************************************************************************/
+c2dSize clauseLbd(Clause* clause, SatState* sat_state) {
+  c2dSize i, level, lbd = 0;
+
+  sat_state->stamp++;
+  for (i=0; i<clause->size; i++) {
+    level = sat_state->litLevel[clause->codes[i]^1];
+    if (level==0)
+      level = sat_state->litLevel[clause->codes[i]];
+    if (sat_state->levelStamp[level]!=sat_state->stamp) {
+      sat_state->levelStamp[level] = sat_state->stamp;
+      lbd++;
+    }
+  }
+  return lbd;
+}
+/******************************************************************************
+* clauseBump()       :
+* a learned clause took part in conflict analysis, raise its activity and
+* keep the smallest lbd it has shown
+*******************************************************************************/
+void clauseBump(Clause* clause, SatState* sat_state) {
+  c2dSize lbd;
+
+  clause->activity += sat_state->clauseInc;
+  if (clause->activity>1e20)
+    activityRescale(sat_state);
+  if (clause->lbd>2) {
+    lbd = clauseLbd(clause, sat_state);
+    if (lbd<clause->lbd)
+      clause->lbd = lbd;
+  }
+}
+/******************************************************************************
+* activityRescale()       :
+* scale all learned clause activities down before they overflow
+*******************************************************************************/
+void activityRescale(SatState* sat_state) {
+  c2dSize i;
+
+  for (i=sat_state->m; i<sat_state->m+sat_state->l; i++)
+    sat_state->delta[i]->activity *= 1e-20;
+  sat_state->clauseInc *= 1e-20;
+}
+/******************************************************************************
+* clauseLocked()       :
+* whether the clause is the reason of a literal, set or still in the queue
+*******************************************************************************/
+BOOLEAN clauseLocked(Clause* clause, SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<clause->size; i++)
+    if (sat_state->litReason[clause->codes[i]]==(Reason)clause)
+      return 1;
+  return 0;
+}
+/******************************************************************************
+* learnedCompare()       :
+* order for reduction, the clauses to delete first come first:
+* larger lbd, then lower activity
+*******************************************************************************/
+int learnedCompare(const void* a, const void* b) {
+  const Clause* x = *(Clause* const*)a;
+  const Clause* y = *(Clause* const*)b;
+
+  if (x->lbd!=y->lbd)
+    return x->lbd>y->lbd ? -1 : 1;
+  if (x->activity!=y->activity)
+    return x->activity<y->activity ? -1 : 1;
+  return 0;
+}
+/******************************************************************************
+* learnedReduce()       :
+* delete half of the learned clauses that are not in the kept tier
+* clauses of lbd <= 2 (binary and unit clauses included) are always kept, but
+* for the longer ones imported from another sat state, and so are clauses that
+* are currently reasons
+* the deleted clauses are dropped from the watch and ternary lists, the rest are compacted
+* to the front of the learned part of delta and renumbered
+*******************************************************************************/
+void learnedReduce(SatState* sat_state) {
+  c2dSize i, j, count = 0;
+  Clause** candidates = (Clause**)malloc(sizeof(Clause*)*sat_state->l);
+  Clause* clause;
+  WatchList* watch;
+  TernaryList* list;
+
+  for (i=sat_state->m; i<sat_state->m+sat_state->l; i++) {
+    clause = sat_state->delta[i];
+    if (clause->size>2 && (clause->lbd>2 || clause->imported) && !clauseLocked(clause, sat_state))
+      candidates[count++] = clause;
+  }
+  qsort(candidates, count, sizeof(Clause*), learnedCompare);
+  for (i=0; i<count/2; i++)
+    candidates[i]->removed = 1;
+  free(candidates);
+
+  for (i=0; i<2*sat_state->n; i++) {
+    watch = &sat_state->watches[i];
+    for (j=0, count=0; j<watch->size; j++)
+      if (!watch->clauses[j]->removed)
+        watch->clauses[count++] = watch->clauses[j];
+    watch->size = count;
+    list = &sat_state->ternaries[i];
+    for (j=0, count=0; j<list->size; j++)
+      if (!list->entries[j].clause->removed)
+        list->entries[count++] = list->entries[j];
+    list->size = count;
+  }
+
+  for (i=sat_state->m, j=sat_state->m; i<sat_state->m+sat_state->l; i++) {
+    clause = sat_state->delta[i];
+    if (clause->removed) {
+      free(clause->lits);
+      free(clause);
+      sat_state->deleted++;
+    }
+    else {
+      clause->index = j+1;
+      sat_state->delta[j++] = clause;
+    }
+  }
+  if (PRINT)
+    printf("Reduce: %ld -> %ld learned clauses\n", sat_state->l, j-sat_state->m);
+  sat_state->l = j-sat_state->m;
+
+  sat_state->reduceInc += REDUCE_INC;
+  sat_state->reduceLimit = sat_state->l+sat_state->reduceInc;
 }
 // /******************************************************************************
 // * firstUIP()       :
@@ -464,28 +818,49 @@ void firstUIP(Clause* clause, SatState* sat_state) {
 // }
 /******************************************************************************
 * literalUnset       :
-* used for undo unit-resolution
+* used for undo unit-resolution, watches stay valid when literals are unset so
+* only the subsumed clauses need to be restored
 *******************************************************************************/
 void literalUnset(Lit* lit, SatState* sat_state) {
   c2dSize i;
   Clause* clause;
 
-  ASSERT_TEST(lit->opp->setLevel==0); // opposite literal should not be set (conflict testing in a different way)
+  ASSERT_TEST(OPP_LEVEL(lit, sat_state)==0); // opposite literal should not be set (conflict testing in a different way)
 
   for (i=0; i<lit->occurSize; i++) { // check the clause has the lit if is set at this level
     clause = lit->occurIn[i];
     if (clause->setLevel == sat_state->currentLevel)
-      clause->setLevel = 0; // set subsumed clause at this level to initial state
+      clauseUnsubsume(clause, sat_state); // set subsumed clause at this level to initial state
   }
-  lit->setLevel = 0;
-  lit->reason = NULL;
+  LEVEL(lit, sat_state) = 0;
+  REASON(lit, sat_state) = 0;
+  sat_state->varPhase[lit->code>>1] = !(lit->code&1);
+  if (sat_state->heapPos[lit->code>>1]==HEAP_NONE)
+    heapInsert(lit->code>>1, sat_state);
+  if (sat_state->xorRows!=NULL)
+    xorUnassign(lit->code, sat_state);
+  if (sat_state->card!=NULL)
+    cardUnassign(lit->code, sat_state);
+}
+/******************************************************************************
+* clauseSubsume, clauseUnsubsume :
+* a cnf clause becomes subsumed at the current level, or back to unsubsumed,
+* the counters of the variables it mentions follow so sat_irrelevant_var()
+* needs no scan
+*******************************************************************************/
+void clauseSubsume(Clause* clause, SatState* sat_state) {
+  c2dSize i;
 
-  lit = lit->opp; // focus on the opposite occurrence
-  for (i=0; i<lit->occurSize; i++) { // update falsenum for every clause that has opposite literal l
-    clause = lit->occurIn[i];
-    clause->falseLit--;
-    ASSERT_TEST(clause->falseLit>=0); // trivial test
-  }
+  clause->setLevel = sat_state->currentLevel;
+  for (i=0; i<clause->size; i++)
+    sat_state->varUnsubsumed[clause->codes[i]>>1]--;
+}
+void clauseUnsubsume(Clause* clause, SatState* sat_state) {
+  c2dSize i;
+
+  clause->setLevel = 0;
+  for (i=0; i<clause->size; i++)
+    sat_state->varUnsubsumed[clause->codes[i]>>1]++;
 }
 /**********************************************************************
 * end of functions for unit-resolution
@@ -493,6 +868,129 @@ void literalUnset(Lit* lit, SatState* sat_state) {
 * file operation begin
 **********************************************************************/
 /**********************************************************************
+* a sat state with nothing in it yet, at level 1
+**********************************************************************/
+SatState* stateNew(void) {
+  SatState* sat_state = (SatState*)malloc(sizeof(SatState));
+
+  sat_state->l = 0;
+  sat_state->currentLevel = 1;
+  sat_state->assertionLevel = 0;
+  sat_state->learned = NULL;
+  sat_state->setCount = 0;
+  sat_state->setHead = 0;
+  sat_state->xorHead = 0;
+  sat_state->queueSize = 0;
+  sat_state->units = NULL;
+  sat_state->unitCount = 0;
+  sat_state->unitCap = 0;
+  sat_state->minClearCount = 0;
+  sat_state->minLocal = 0;
+  sat_state->minRecursive = 0;
+  sat_state->clauseInc = 1;
+  sat_state->stamp = 0;
+  sat_state->reduceLimit = REDUCE_FIRST;
+  sat_state->reduceInc = REDUCE_FIRST;
+  sat_state->deleted = 0;
+  sat_state->arena = NULL;
+  sat_state->arenaUsed = 0;
+  sat_state->arenaSize = 0;
+  sat_state->occurPool = NULL;
+  sat_state->pending = NULL;
+  sat_state->elimStack = NULL;
+  sat_state->elimSize = 0;
+  sat_state->elimCap = 0;
+  memset(&sat_state->prepStats, 0, sizeof(PrepStats));
+  memset(&sat_state->probeStats, 0, sizeof(ProbeStats));
+  sat_state->xorRows = NULL;
+  memset(&sat_state->xorStats, 0, sizeof(XorStats));
+  sat_state->card = NULL;
+  memset(&sat_state->cardStats, 0, sizeof(CardStats));
+  sat_state->empty = 0;
+  memset(&sat_state->solveStats, 0, sizeof(SolveStats));
+  sat_state->determined = 0;
+  sat_state->parseBytes = 0;
+  sat_state->parseTime = 0;
+  sat_state->conflict = 0;
+  return sat_state;
+}
+/**********************************************************************
+* the arrays over variables, literals and clauses, once n and m are known
+**********************************************************************/
+void stateAlloc(SatState* sat_state) {
+  c2dSize i;
+
+  sat_state->deltaCap = sat_state->m>0 ? sat_state->m : 1;
+  sat_state->delta = (Clause**)malloc(sizeof(Clause*)*sat_state->deltaCap);  // initial delta
+  sat_state->variables = (Var**)malloc(sizeof(Var*)*sat_state->n);
+  sat_state->set = (Lit**)malloc(sizeof(Lit*)*sat_state->n);
+  sat_state->queue = (Lit**)malloc(sizeof(Lit*)*sat_state->n);
+  sat_state->varPool = (Var*)malloc(sizeof(Var)*sat_state->n);
+  sat_state->literals = (Lit*)malloc(sizeof(Lit)*2*sat_state->n);
+  sat_state->litLevel = (c2dSize*)calloc(2*sat_state->n, sizeof(c2dSize));
+  sat_state->litReason = (Reason*)calloc(2*sat_state->n, sizeof(Reason));
+  sat_state->litSeen = (BOOLEAN*)calloc(2*sat_state->n, sizeof(BOOLEAN));
+  sat_state->litQueued = (BOOLEAN*)calloc(2*sat_state->n, sizeof(BOOLEAN));
+  sat_state->varUnsubsumed = (c2dSize*)calloc(sat_state->n, sizeof(c2dSize));
+  sat_state->watches = (WatchList*)calloc(2*sat_state->n, sizeof(WatchList));
+  sat_state->binaries = (BinaryList*)calloc(2*sat_state->n, sizeof(BinaryList));
+  sat_state->ternaries = (TernaryList*)calloc(2*sat_state->n, sizeof(TernaryList));
+  sat_state->learnBuffer = (Lit**)malloc(sizeof(Lit*)*2*sat_state->n);
+  sat_state->minStack = (Lit**)malloc(sizeof(Lit*)*sat_state->n);
+  sat_state->minClear = (Lit**)malloc(sizeof(Lit*)*sat_state->n);
+  sat_state->levelStamp = (c2dSize*)calloc(sat_state->n+2, sizeof(c2dSize)); // levels go from 1 to n+1
+  orderAlloc(sat_state);
+  for (i=0;i<sat_state->n;i++)
+    sat_state->variables[i] = var_new(i+1, sat_state);  // initial variables
+  sat_state->binaryConflict = clause_init(malloc(CLAUSE_BYTES(2)), 0, 0, NULL, sat_state);
+  sat_state->binaryConflict->size = 2;
+  sat_state->binaryReason = clause_init(malloc(CLAUSE_BYTES(2)), 0, 0, NULL, sat_state);
+  sat_state->binaryReason->size = 2;
+}
+/**********************************************************************
+* the cnf clauses of a sat state without learned clauses are dropped,
+* with their lists, so that others can be placed (sat_preprocess())
+**********************************************************************/
+void stateClear(SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<2*sat_state->n; i++) {
+    free(sat_state->watches[i].clauses);
+    free(sat_state->binaries[i].others);
+    free(sat_state->ternaries[i].entries);
+  }
+  memset(sat_state->watches, 0, sizeof(WatchList)*2*sat_state->n);
+  memset(sat_state->binaries, 0, sizeof(BinaryList)*2*sat_state->n);
+  memset(sat_state->ternaries, 0, sizeof(TernaryList)*2*sat_state->n);
+  memset(sat_state->varUnsubsumed, 0, sizeof(c2dSize)*sat_state->n);
+  for (i=0; i<sat_state->m; i++)
+    free(sat_state->delta[i]->lits);
+  xorFree(sat_state);
+  arenaFree(sat_state);
+  sat_state->arenaUsed = 0;
+  sat_state->arenaSize = 0;
+  free(sat_state->occurPool);
+  sat_state->occurPool = NULL;
+  sat_state->unitCount = 0;
+  sat_state->m = 0;
+}
+/**********************************************************************
+* the binary, ternary and watch lists are allocated at the capacity
+* counted before the clauses are attached
+**********************************************************************/
+void listsAlloc(SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<2*sat_state->n; i++) {
+    if (sat_state->binaries[i].cap>0)
+      sat_state->binaries[i].others = (LitCode*)malloc(sizeof(LitCode)*sat_state->binaries[i].cap);
+    if (sat_state->ternaries[i].cap>0)
+      sat_state->ternaries[i].entries = (Ternary*)malloc(sizeof(Ternary)*sat_state->ternaries[i].cap);
+    if (sat_state->watches[i].cap>0)
+      sat_state->watches[i].clauses = (Clause**)malloc(sizeof(Clause*)*sat_state->watches[i].cap);
+  }
+}
+/**********************************************************************
 * given file_name, initial the parameter for sat_state
 * especially, initialize for the following:
 * struct clause**     delta;
@@ -505,6 +1003,316 @@ void literalUnset(Lit* lit, SatState* sat_state) {
 **********************************************************************/
 void parseFile(char* in, SatState* sat_state) {
   c2dSize i = 0;
+  c2dSize count;
+  c2dSize* counts;
+  LitCode* codes;
+
+  while (1) {
+    skipWhitespace(&in);
+    if (*in == 'c')  // comment line
+      skipLine(&in);
+    else if (*in == 'p')  // data input begin
+      break;
+    else
+      fprintf(stderr, "ERROR! Missing problem line.\n"), exit(-1);
+  }
+  parseProblem(&in, sat_state);
+
+  // first pass: occurrences of each literal, bytes of the clauses and
+  // the capacity of each binary, ternary and watch list
+  codes = (LitCode*)malloc(sizeof(LitCode)*2*sat_state->n);
+  counts = (c2dSize*)calloc(2*sat_state->n, sizeof(c2dSize));
+  count = parseClauses(in, codes, counts, 0, sat_state);
+  sat_state->m = count; // the clauses of the file, whatever the problem line says
+  deltaFit(count, sat_state);
+  occurPlace(counts, sat_state);
+  listsAlloc(sat_state);
+  arenaReserve(sat_state->arenaSize, sat_state); // the first pass left the bytes needed there
+
+  // second pass: the clauses, into the space found above
+  i = parseClauses(in, codes, counts, 1, sat_state);
+  occurClose(counts, sat_state);
+  free(counts);
+  free(codes);
+  ASSERT_TEST(i==sat_state->m);  // test number of clause read in match with m
+}
+/**********************************************************************
+* the problem line, then the arrays of the sat state
+**********************************************************************/
+void parseProblem(char** in, SatState* sat_state) {
+  (*in)++;
+  skipWhitespace(in);
+  *in += 3;   // "cnf"
+  sat_state->n = parseNum(in);
+  sat_state->m = parseNum(in);
+  skipLine(in);  // end this line
+  stateAlloc(sat_state);
+}
+/**********************************************************************
+* room in delta for count clauses, the clauses found when the problem
+* line has fewer of them
+**********************************************************************/
+void deltaFit(c2dSize count, SatState* sat_state) {
+  if (count>sat_state->deltaCap) {
+    sat_state->deltaCap = count;
+    sat_state->delta = realloc(sat_state->delta, sizeof(Clause*)*sat_state->deltaCap);
+  }
+}
+/**********************************************************************
+* occurPlace, occurClose :
+* given the occurrences of each literal code in counts, place the lists
+* in occurPool, counts then holds where the next occurrence of each
+* literal goes, once all are there set the sizes and varUnsubsumed
+**********************************************************************/
+void occurPlace(c2dSize* counts, SatState* sat_state) {
+  c2dSize i;
+  c2dSize total = 0;
+
+  for (i=0; i<2*sat_state->n; i++)
+    total += counts[i];
+  sat_state->occurPool = (Clause**)malloc(sizeof(Clause*)*total);
+  total = 0;
+  for (i=0; i<2*sat_state->n; i++) {
+    sat_state->literals[i].occurIn = sat_state->occurPool+total;
+    total += counts[i];
+    counts[i] = total-counts[i];
+  }
+}
+void occurClose(c2dSize* counts, SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<2*sat_state->n; i++) {
+    sat_state->literals[i].occurSize = sat_state->occurPool+counts[i]-sat_state->literals[i].occurIn;
+    sat_state->varUnsubsumed[i>>1] += sat_state->literals[i].occurSize;
+  }
+}
+/**********************************************************************
+* open the cnf file (dimacs, compressed dimacs or a snapshot) and load
+* it, mapped when possible, and record the throughput in parseBytes
+* (of text, once decompressed) and parseTime
+**********************************************************************/
+BOOLEAN loadFile(const char* file_name, SatState* sat_state) {
+  FILE* fin;
+  char* data;
+  unsigned char magic[8];
+  c2dSize magicSize = 0;
+  BOOLEAN mapped;
+  Codec codec;
+  c2dSize bytes = 0;
+  clock_t start = clock();
+
+  fin = fopen(file_name, "rb");
+  if (fin == NULL) {
+    fprintf(stderr, "ERROR! Could not open file: %s\n", file_name);
+    return 0;
+  }
+  data = mapFile(fileno(fin), &bytes);
+  mapped = data != NULL;
+  if (mapped)
+    codec = streamCodec((unsigned char*)data, bytes);
+  else { // pipes and the like, the codec is found on the first bytes read
+    magicSize = fread(magic, 1, sizeof(magic), fin);
+    codec = streamCodec(magic, magicSize);
+    if (codec == CODEC_NONE) // read into memory
+      data = readFile(fin, magic, magicSize, &bytes);
+  }
+  if (codec != CODEC_NONE) {
+    if (mapped)
+      unmapFile(data, bytes); // read through fin, from its start
+    bytes = streamLoad(fin, codec, magic, magicSize, sat_state);
+  }
+  else {
+    if (bytes>=sizeof(SnapshotHeader) && memcmp(data, SNAPSHOT_MAGIC, 8)==0)
+      snapshotLoad(data, bytes, sat_state);
+    else
+      parseFile(data, sat_state);
+    if (mapped)
+      unmapFile(data, bytes);
+    else
+      free(data);
+  }
+  fclose(fin);
+  sat_state->parseBytes = bytes;
+  sat_state->parseTime = ((double)(clock()-start))/CLOCKS_PER_SEC;
+  xorDetect(sat_state);
+  return 1;
+}
+/**********************************************************************
+* a snapshot is the cnf as parsed, in native byte order:
+* the header, the start of each clause in the codes (m+1), the start of
+* each literal in the occurrences (2n+1), the occurrences as 32 bit
+* clause positions, and the codes of all the clauses
+* loading copies the codes into one arena block and places the clauses
+* with the lists of snapshotValid(), there is nothing to parse; the
+* occurrences are placed again from the codes, at the starts of the
+* literals, rather than trusted
+**********************************************************************/
+void snapshotLoad(char* data, c2dSize bytes, SatState* sat_state) {
+  c2dSize i;
+  SnapshotHeader* header = (SnapshotHeader*)data;
+  c2dSize* clauseStart;
+  c2dSize* litStart;
+  c2dSize* next;
+  uint32_t* occurs;
+  LitCode* codes;
+
+  if (!snapshotValid(data, bytes))
+    fprintf(stderr, "ERROR! Truncated or corrupt snapshot.\n"), exit(-1);
+  sat_state->n = header->n;
+  sat_state->m = header->m;
+  clauseStart = (c2dSize*)(header+1);
+  litStart = clauseStart+sat_state->m+1;
+  occurs = (uint32_t*)(litStart+2*sat_state->n+1);
+  codes = (LitCode*)(occurs+header->occurCount);
+  stateAlloc(sat_state);
+
+  for (i=0; i<sat_state->m; i++)
+    clauseReserve(codes+clauseStart[i], clauseStart[i+1]-clauseStart[i], sat_state);
+  listsAlloc(sat_state);
+  arenaReserve(header->arenaBytes, sat_state);
+  sat_state->occurPool = (Clause**)malloc(sizeof(Clause*)*header->occurCount);
+  next = (c2dSize*)malloc(sizeof(c2dSize)*2*sat_state->n);
+  for (i=0; i<2*sat_state->n; i++) {
+    sat_state->literals[i].occurIn = sat_state->occurPool+litStart[i];
+    next[i] = litStart[i];
+  }
+  for (i=0; i<sat_state->m; i++)
+    clausePlace(i+1, clauseStart[i+1]-clauseStart[i], codes+clauseStart[i], next, sat_state);
+  occurClose(next, sat_state);
+  free(next);
+}
+/**********************************************************************
+* whether the snapshot is one snapshotSave() may have written: its size
+* is that of the header's counts, the starts of the clauses increase
+* from 0 to codeCount, the codes are below 2n and none is repeated in a
+* clause (the watches need distinct literals), the literals start where
+* their occurrences in the codes put them, occurCount is codeCount, the
+* clause positions are below m, and arenaBytes is the arena space of
+* the clauses
+* the counts are first bounded by bytes, so the size does not overflow
+**********************************************************************/
+BOOLEAN snapshotValid(const char* data, c2dSize bytes) {
+  c2dSize i, j;
+  c2dSize arenaBytes = 0;
+  c2dSize total = 0;
+  c2dSize* counts;
+  BOOLEAN valid = 1;
+  const SnapshotHeader* header = (const SnapshotHeader*)data;
+  const c2dSize* clauseStart;
+  const c2dSize* litStart;
+  const uint32_t* occurs;
+  const LitCode* codes;
+
+  if (header->n>bytes || header->m>bytes || header->codeCount>bytes || header->occurCount!=header->codeCount
+      || bytes!=SNAPSHOT_BYTES(header))
+    return 0;
+  clauseStart = (const c2dSize*)(header+1);
+  litStart = clauseStart+header->m+1;
+  occurs = (const uint32_t*)(litStart+2*header->n+1);
+  codes = (const LitCode*)(occurs+header->occurCount);
+
+  if (clauseStart[0]!=0 || clauseStart[header->m]!=header->codeCount)
+    return 0;
+  for (i=0; i<header->m; i++) {
+    if (clauseStart[i+1]<clauseStart[i])
+      return 0;
+    arenaBytes += ARENA_ROUND(CLAUSE_BYTES(clauseStart[i+1]-clauseStart[i]));
+  }
+  if (arenaBytes!=header->arenaBytes)
+    return 0;
+  for (i=0; i<header->codeCount; i++)
+    if (codes[i]>=2*header->n)
+      return 0;
+  for (i=0; i<header->occurCount; i++)
+    if (occurs[i]>=header->m)
+      return 0;
+
+  // counts[code] is the clause of its last occurrence, plus 1, while the
+  // clauses are read, then the number of its occurrences
+  counts = (c2dSize*)calloc(2*header->n+1, sizeof(c2dSize));
+  for (i=0; i<header->m && valid; i++)
+    for (j=clauseStart[i]; j<clauseStart[i+1] && valid; j++) {
+      valid = counts[codes[j]]!=i+1;
+      counts[codes[j]] = i+1;
+    }
+  if (valid) {
+    memset(counts, 0, sizeof(c2dSize)*2*header->n);
+    for (i=0; i<header->codeCount; i++)
+      counts[codes[i]]++;
+    for (i=0; i<2*header->n && valid; i++) {
+      valid = litStart[i]==total;
+      total += counts[i];
+    }
+    valid = valid && litStart[2*header->n]==total;
+  }
+  free(counts);
+  return valid;
+}
+/**********************************************************************
+* write the cnf clauses of the sat state as a snapshot
+* (learned clauses are not kept)
+* returns 0 on a write error, or when there are 2^32 clauses or more
+**********************************************************************/
+BOOLEAN snapshotSave(const SatState* sat_state, FILE* out) {
+  c2dSize i;
+  c2dSize j;
+  c2dSize start;
+  uint32_t position;
+  Lit* lit;
+  SnapshotHeader header;
+
+  if (sat_state->m>UINT32_MAX)
+    return 0; // the clause positions would not fit
+  if (sat_state->card!=NULL)
+    return 0; // the binary clauses of the constraints are not in the cnf
+
+  memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+  header.n = sat_state->n;
+  header.m = sat_state->m;
+  header.codeCount = 0;
+  header.occurCount = 0;
+  header.arenaBytes = 0;
+  for (i=0; i<sat_state->m; i++) {
+    header.codeCount += sat_state->delta[i]->size;
+    header.arenaBytes += ARENA_ROUND(CLAUSE_BYTES(sat_state->delta[i]->size));
+  }
+  for (i=0; i<2*sat_state->n; i++)
+    header.occurCount += sat_state->literals[i].occurSize;
+  fwrite(&header, sizeof(SnapshotHeader), 1, out);
+
+  for (i=0, start=0; i<=sat_state->m; i++) {
+    fwrite(&start, sizeof(c2dSize), 1, out);
+    if (i<sat_state->m)
+      start += sat_state->delta[i]->size;
+  }
+  for (i=0, start=0; i<=2*sat_state->n; i++) {
+    fwrite(&start, sizeof(c2dSize), 1, out);
+    if (i<2*sat_state->n)
+      start += sat_state->literals[i].occurSize;
+  }
+  for (i=0; i<2*sat_state->n; i++) {
+    lit = &sat_state->literals[i];
+    for (j=0; j<lit->occurSize; j++) {
+      position = lit->occurIn[j]->index-1;
+      fwrite(&position, sizeof(uint32_t), 1, out);
+    }
+  }
+  for (i=0; i<sat_state->m; i++)
+    fwrite(sat_state->delta[i]->codes, sizeof(LitCode), sat_state->delta[i]->size, out);
+  return !ferror(out);
+}
+/**********************************************************************
+* walk the clauses after the problem line, without fill only count the
+* occurrences of each literal code (in counts), the arena bytes (in
+* arenaSize) and the lists of clauseAttach (in their cap), with fill
+* add the clauses, counts then holds where the next occurrence goes
+* codes is scratch for one clause
+* it stops at text that is not a clause (the % line of some files)
+* returns the number of clauses
+**********************************************************************/
+c2dSize parseClauses(char* in, LitCode* codes, c2dSize* counts, BOOLEAN fill, SatState* sat_state) {
+  c2dSize i = 0;
+  c2dSize size;
 
   while (1) {
     skipWhitespace(&in);
@@ -512,47 +1320,72 @@ void parseFile(char* in, SatState* sat_state) {
       break;
     else if (*in == 'c')  // comment line
       skipLine(&in);
-    else if (*in == 'p') { // data input begin
-      in++;
-      skipWhitespace(&in);
-      in += 3;   // "cnf"
-      sat_state->n = parseNum(&in);
-      sat_state->m = parseNum(&in);
-      sat_state->delta = (Clause**)malloc(sizeof(Clause*)*sat_state->m);  // initial delta
-      sat_state->variables = (Var**)malloc(sizeof(Var*)*sat_state->n);
-      sat_state->set = (Lit**)malloc(sizeof(Lit*)*sat_state->n);
-      sat_state->queue = (Lit**)malloc(sizeof(Lit*)*sat_state->n);
-      for (i=0;i<sat_state->n;i++)
-        sat_state->variables[i] = var_new(i+1);  // initial variables
-      i = 0;
-      skipLine(&in);  // end this line
-    }
-    else if (*in == '-' || (*in > '0' && *in <= '9')) {
-      addClause(&in, sat_state, i+1);  // value of clause index by i+1
+    else if (*in == '-' || (*in >= '0' && *in <= '9')) {  // a line of 0 is the empty clause
+      if (fill)
+        addClause(&in, codes, counts, sat_state, i+1);  // value of clause index by i+1
+      else {
+        size = clauseRead(&in, codes, sat_state);
+        clauseCount(codes, size, counts, sat_state);
+      }
       i++;
     }
     else
       break;
   }
-  ASSERT_TEST(i==sat_state->m);  // test number of clause read in match with m
+  return i;
+}
+/**********************************************************************
+* map the file, with zero bytes after it so the parser still finds the
+* terminating 0, the file stays shared with the page cache instead of
+* being copied
+* returns NULL when the file can not be mapped (not a regular file),
+* the caller then uses readFile
+**********************************************************************/
+char* mapFile(int fd, c2dSize* bytes) {
+  struct stat st;
+  char* data;
+  c2dSize size;
+  c2dSize page = sysconf(_SC_PAGESIZE);
+
+  if (fstat(fd, &st)!=0 || !S_ISREG(st.st_mode) || st.st_size==0)
+    return NULL;
+  size = (st.st_size/page+1)*page; // at least one byte past the end of the file
+  data = mmap(NULL, size, PROT_READ, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0); // zero pages
+  if (data==MAP_FAILED)
+    return NULL;
+  if (mmap(data, st.st_size, PROT_READ, MAP_PRIVATE|MAP_FIXED, fd, 0)==MAP_FAILED) {
+    munmap(data, size);
+    return NULL;
+  }
+  madvise(data, st.st_size, MADV_SEQUENTIAL);
+  *bytes = st.st_size;
+  return data;
+}
+void unmapFile(char* data, c2dSize bytes) {
+  c2dSize page = sysconf(_SC_PAGESIZE);
+
+  munmap(data, (bytes/page+1)*page);
 }
 /**********************************************************************
 * return the data from the opened file
 **********************************************************************/
-char* readFile(FILE *  in) {
+char* readFile(FILE *  in, const unsigned char* prefix, c2dSize prefixSize, c2dSize* bytes) {
   char*   data = malloc(65536);
-  int     cap  = 65536;
-  int     size = 0;
+  c2dSize cap  = 65536;
+  c2dSize size = prefixSize;  // bytes already read from in
+
+  memcpy(data, prefix, prefixSize);
 
-  while (!feof(in)) {
-    if (size == cap) {
+  while (!feof(in) && !ferror(in)) {
+    if (cap-size < 65536) { // room for a whole read, short reads leave size anywhere
       cap *= 2;
-      data = realloc(data, cap); 
+      data = realloc(data, cap);
     }
     size += fread(&data[size], 1, 65536, in);
   }
   data = realloc(data, size+1);
   data[size] = '\0';
+  *bytes = size;
 
   return data;
 }
@@ -602,13 +1435,14 @@ c2dSize parseNum(char** in) {
 /**********************************************************************
 * variable init
 **********************************************************************/
-Var* var_new(c2dSize index) {
-  Var* var = (Var*)malloc(sizeof(Var));
+Var* var_new(c2dSize index, SatState* sat_state) {
+  Var* var = &sat_state->varPool[index-1];
 
   var->index = index;
+  var->unsubsumed = sat_state->varUnsubsumed;
 
-  var->pos = lit_new(index);
-  var->neg = lit_new(-index);
+  var->pos = lit_new(index, sat_state);
+  var->neg = lit_new(-index, sat_state);
 
   var->pos->var = var;
   var->neg->var = var;
@@ -619,83 +1453,285 @@ Var* var_new(c2dSize index) {
   return var;
 }
 /**********************************************************************
-* lit init
+* lit init, the literal lives at its code in sat_state->literals and its
+* state in the per literal arrays (all 0 from calloc)
 **********************************************************************/
-Lit* lit_new(c2dLiteral index) {
-  Lit* lit = (Lit*)malloc(sizeof(Lit));
+Lit* lit_new(c2dLiteral index, SatState* sat_state) {
+  LitCode code = LITERAL_CODE(index);
+  Lit* lit = &sat_state->literals[code];
 
   lit->index = index;
-  lit->setLevel = 0;
+  lit->code = code;
+  lit->level = sat_state->litLevel;
 
-  lit->occurIn = (Clause**)malloc(0);
+  lit->occurIn = NULL; // placed in sat_state->occurPool once the clauses are counted
   lit->occurSize = 0;
-  
-  lit->inQueue = 0;
-  lit->seen = 0;
-
-  lit->reason = NULL;
   return lit;
 }
-void lit_addOccur(Lit* lit, Clause* clause) {
-  lit->occurSize++;
-  lit->occurIn = realloc(lit->occurIn, sizeof(Clause*)*lit->occurSize);
-  lit->occurIn[lit->occurSize-1] = clause;
+void lit_addWatch(LitCode code, Clause* clause, SatState* sat_state) {
+  WatchList* watch = &sat_state->watches[code];
+
+  if (watch->size==watch->cap) { // watches move between literals, grow geometrically
+    watch->cap = watch->cap ? 2*watch->cap : 4;
+    watch->clauses = realloc(watch->clauses, sizeof(Clause*)*watch->cap);
+  }
+  watch->clauses[watch->size++] = clause;
+}
+void lit_addBinary(LitCode code, LitCode other, SatState* sat_state) {
+  BinaryList* list = &sat_state->binaries[code];
+
+  if (list->size==list->cap) {
+    list->cap = list->cap ? 2*list->cap : 4;
+    list->others = realloc(list->others, sizeof(LitCode)*list->cap);
+  }
+  list->others[list->size++] = other;
 }
-Clause* clause_new(c2dSize index, c2dSize size, Lit** lits) {
-  Clause* clause = (Clause*)malloc(sizeof(Clause));
+void lit_addTernary(LitCode code, LitCode a, LitCode b, Clause* clause, SatState* sat_state) {
+  TernaryList* list = &sat_state->ternaries[code];
+
+  if (list->size==list->cap) {
+    list->cap = list->cap ? 2*list->cap : 4;
+    list->entries = realloc(list->entries, sizeof(Ternary)*list->cap);
+  }
+  list->entries[list->size].a = a;
+  list->entries[list->size].b = b;
+  list->entries[list->size++].clause = clause;
+}
+/**********************************************************************
+* a clause is one block: the header followed by the codes of its literals
+* cnf clauses are placed in the arena, learned clauses are allocated on
+* their own since the reduction frees them one by one
+**********************************************************************/
+Clause* clause_new(c2dSize index, c2dSize size, Lit** lits, SatState* sat_state) {
+  return clause_init(malloc(CLAUSE_BYTES(size)), index, size, lits, sat_state);
+}
+Clause* clause_init(void* block, c2dSize index, c2dSize size, Lit** lits, SatState* sat_state) {
+  c2dSize i;
+  Clause* clause = (Clause*)block;
 
   clause->index = index;
-  clause->lits = lits;  
   clause->size = size;
-  clause->falseLit = 0;
+  for (i=0; i<size; i++)
+    clause->codes[i] = lits[i]->code;
+  clause->table = sat_state->literals;
+  clause->lits = NULL;
   clause->setLevel = 0;
+  clause->activity = 0;
+  clause->lbd = 0;
+  clause->removed = 0;
+  clause->imported = 0;
   clause->mark = 0;
   return clause;
 }
 /**********************************************************************
+* the literal array of a clause, for callers of sat_clause_literals()
+* built on the first request and refreshed after, since the watches
+* reorder the codes
+**********************************************************************/
+Lit** clause_view(Clause* clause) {
+  c2dSize i;
+
+  if (clause->lits==NULL && clause->size>0)
+    clause->lits = (Lit**)malloc(sizeof(Lit*)*clause->size);
+  for (i=0; i<clause->size; i++)
+    clause->lits[i] = &clause->table[clause->codes[i]];
+  return clause->lits;
+}
+/**********************************************************************
+* clause arena, bump allocation in blocks of ARENA_BLOCK bytes (or one
+* larger block for a very long clause), freed all at once
+**********************************************************************/
+void* arenaAlloc(c2dSize bytes, SatState* sat_state) {
+  char* block;
+
+  bytes = ARENA_ROUND(bytes);
+  if (sat_state->arena==NULL || sat_state->arenaUsed+bytes>sat_state->arenaSize)
+    arenaReserve(bytes>ARENA_BLOCK ? bytes : ARENA_BLOCK, sat_state);
+  block = sat_state->arena+sat_state->arenaUsed;
+  sat_state->arenaUsed += bytes;
+  return block;
+}
+/**********************************************************************
+* start a new block with room for exactly bytes, the parser reserves
+* all the cnf clauses at once
+**********************************************************************/
+void arenaReserve(c2dSize bytes, SatState* sat_state) {
+  char* block;
+
+  sat_state->arenaSize = bytes+sizeof(char*);
+  block = (char*)malloc(sat_state->arenaSize);
+  *(char**)block = sat_state->arena;
+  sat_state->arena = block;
+  sat_state->arenaUsed = sizeof(char*);
+}
+void arenaFree(SatState* sat_state) {
+  char* block;
+
+  while (sat_state->arena!=NULL) {
+    block = sat_state->arena;
+    sat_state->arena = *(char**)block;
+    free(block);
+  }
+}
+/**********************************************************************
 * clause init
 **********************************************************************/
-void addClause(char** in, SatState* sat_state, c2dSize index) {  // index is the index of current clause
-  c2dSize parsedNum;
-  c2dSize size=0;
-  char sign;
-  Var* var;
-  Lit** lits;
-  Lit* lit;
+void addClause(char** in, LitCode* codes, c2dSize* next, SatState* sat_state, c2dSize index) {  // index is the index of current clause
+  c2dSize size;
+
+  size = clauseRead(in, codes, sat_state);
+  clausePlace(index, size, codes, next, sat_state);
+}
+/**********************************************************************
+* clauseCount, clausePlace :
+* a cnf clause given by its codes, first counted (occurrences in counts,
+* arena bytes in arenaSize, lists in their cap), then placed in the
+* arena and attached, with its occurrences at next (none when NULL)
+* the empty clause makes the cnf unsatisfiable
+**********************************************************************/
+void clauseCount(LitCode* codes, c2dSize size, c2dSize* counts, SatState* sat_state) {
+  c2dSize i;
+
+  for (i=0; i<size; i++)
+    counts[codes[i]]++;
+  sat_state->arenaSize += ARENA_ROUND(CLAUSE_BYTES(size));
+  clauseReserve(codes, size, sat_state);
+}
+Clause* clausePlace(c2dSize index, c2dSize size, LitCode* codes, c2dSize* next, SatState* sat_state) {
+  c2dSize i;
   Clause* clause;
 
-  clause = (Clause*)malloc(sizeof(Clause));
+  clause = clause_init(arenaAlloc(CLAUSE_BYTES(size), sat_state), index, 0, NULL, sat_state);
+  clause->size = size;
+  memcpy(clause->codes, codes, sizeof(LitCode)*size);
   sat_state->delta[index-1] = clause;
+  if (size==0)
+    sat_state->empty = 1;
+  if (next!=NULL)
+    for (i=0; i<size; i++)
+      sat_state->occurPool[next[codes[i]]++] = clause; //add the clause to literal it mentioned
+
+  clauseAttach(clause, sat_state);
+  return clause;
+}
+/**********************************************************************
+* clause store, for clauses that come as literal codes (compressed input,
+* the builder of sat_api.h) and are placed at the end, all at once
+* storeAdd() appends to the open clause unless the literal is repeated,
+* storeClose() ends it and storeDrop() forgets it
+**********************************************************************/
+void storeInit(ClauseStore* store) {
+  store->codeCount = 0;
+  store->codeCap = 16;
+  store->codes = (LitCode*)malloc(sizeof(LitCode)*store->codeCap);
+  store->count = 0;
+  store->startCap = 16;
+  store->starts = (c2dSize*)malloc(sizeof(c2dSize)*store->startCap);
+  store->starts[0] = 0;
+}
+void storeReserve(ClauseStore* store, c2dSize clauses, c2dSize codes) {
+  if (clauses+1>store->startCap) {
+    store->startCap = clauses+1;
+    store->starts = realloc(store->starts, sizeof(c2dSize)*store->startCap);
+  }
+  if (codes>store->codeCap) {
+    store->codeCap = codes;
+    store->codes = realloc(store->codes, sizeof(LitCode)*store->codeCap);
+  }
+}
+void storeAdd(ClauseStore* store, LitCode code, SatState* sat_state) {
+  if (sat_state->litSeen[code])
+    return; // repeated literal in this clause
+  sat_state->litSeen[code] = 1;
+  if (store->codeCount==store->codeCap) {
+    store->codeCap *= 2;
+    store->codes = realloc(store->codes, sizeof(LitCode)*store->codeCap);
+  }
+  store->codes[store->codeCount++] = code;
+}
+void storeClose(ClauseStore* store, SatState* sat_state) {
+  c2dSize i;
+
+  for (i=store->starts[store->count]; i<store->codeCount; i++)
+    sat_state->litSeen[store->codes[i]] = 0;
+  if (store->count+1==store->startCap) {
+    store->startCap *= 2;
+    store->starts = realloc(store->starts, sizeof(c2dSize)*store->startCap);
+  }
+  store->starts[++store->count] = store->codeCount;
+}
+void storeDrop(ClauseStore* store, SatState* sat_state) {
+  c2dSize i;
+
+  for (i=store->starts[store->count]; i<store->codeCount; i++)
+    sat_state->litSeen[store->codes[i]] = 0;
+  store->codeCount = store->starts[store->count];
+}
+void storeFree(ClauseStore* store) {
+  free(store->codes);
+  free(store->starts);
+}
+/**********************************************************************
+* place the closed clauses of a store, as parseFile() does with the
+* counts of its first pass
+**********************************************************************/
+void storeBuild(ClauseStore* store, SatState* sat_state) {
+  c2dSize i;
+  c2dSize* counts = (c2dSize*)calloc(2*sat_state->n, sizeof(c2dSize));
+
+  for (i=0; i<store->count; i++)
+    clauseCount(store->codes+store->starts[i], store->starts[i+1]-store->starts[i], counts, sat_state);
+  deltaFit(store->count, sat_state);
+  occurPlace(counts, sat_state);
+  listsAlloc(sat_state);
+  arenaReserve(sat_state->arenaSize, sat_state);
+  for (i=0; i<store->count; i++)
+    clausePlace(i+1, store->starts[i+1]-store->starts[i], store->codes+store->starts[i], counts, sat_state);
+  occurClose(counts, sat_state);
+  free(counts);
+}
+/**********************************************************************
+* read the codes of the literals of a clause up to its 0, without
+* repeated literals since the watches need distinct ones
+* returns the number of literals
+**********************************************************************/
+c2dSize clauseRead(char** in, LitCode* codes, SatState* sat_state) {
+  c2dSize i;
+  c2dSize parsedNum;
+  c2dSize size=0;
+  char sign;
+  LitCode code;
+  BOOLEAN* seen = sat_state->litSeen;
 
-  lits = (Lit**)malloc(0); //initial 
   while (1) {
     sign = getSign(in);
     parsedNum = parseNum(in);
     if (parsedNum == 0)
       break;  // end of this clause
     else {
-      var = sat_index2var(parsedNum, sat_state);
-      if (sign == 1)  // positive literal
-        lit = sat_pos_literal(var);
-      else
-        lit = sat_neg_literal(var);
-      size++;   // increase the size of this clause
-      lits = realloc(lits, sizeof(Lit*)*size);  // resize lits
-      lits[size-1] = lit; // add literals to clause
-      lit_addOccur(lit, clause); //add the clause to literal it mentioned
+      if (parsedNum > sat_state->n)
+        fprintf(stderr, "ERROR! Variable %ld out of range in parsing.\n", parsedNum), exit(-1);
+      code = 2*(parsedNum-1)+(sign==0); // straight to the code, without loading the literal
+      if (seen[code])
+        continue; // repeated literal in this clause
+      seen[code] = 1;
+      codes[size++] = code;
     }
   }
-  clause->index = index;
-  clause->lits = lits;
-  clause->size = size;
-  clause->falseLit = 0;
-  clause->setLevel = 0;
-  clause->mark = 0;
-
-  if (size==1 && lits[0]->inQueue==0) { //unit-clause at init level
-    sat_state->queue[sat_state->queueSize++] = lits[0];
-    lits[0]->inQueue = 1;
+  for (i=0; i<size; i++)
+    seen[codes[i]] = 0;
+  return size;
+}
+/**********************************************************************
+* unit clauses (from the cnf or learned) are set whenever unit resolution
+* starts again at level 1
+**********************************************************************/
+void unitAdd(Clause* clause, SatState* sat_state) {
+  if (sat_state->unitCount==sat_state->unitCap) {
+    sat_state->unitCap = sat_state->unitCap ? 2*sat_state->unitCap : 4;
+    sat_state->units = realloc(sat_state->units, sizeof(Clause*)*sat_state->unitCap);
   }
+  sat_state->units[sat_state->unitCount++] = clause;
 }
 /******************************************************************************
 * // print information for clause
@@ -705,7 +1741,7 @@ void printClause(Clause* clause) {
     c2dSize i;
     printf("C %-4ld:\t\t\t", clause->index);
     for (i=0; i<clause->size; i++) {
-      printf("%+-4ld\t\t\t", clause->lits[i]->index);
+      printf("%+-4ld\t\t\t", clause->table[clause->codes[i]].index);
     }
     printf("\n");
   }
@@ -719,7 +1755,7 @@ void printLits(SatState* s) {
   c2dSize i;
   printf("============== Literals ==============\nName\t\t-\t\t+\t\t\n");
   for (i=0; i<s->n; i++)
-    printf("%ld\t\t%ld\t\t%ld\t\t\n", s->variables[i]->index, s->variables[i]->pos->setLevel, s->variables[i]->neg->setLevel);
+    printf("%ld\t\t%ld\t\t%ld\t\t\n", s->variables[i]->index, LEVEL(s->variables[i]->pos, s), LEVEL(s->variables[i]->neg, s));
   printf("\nModel: ");
   for (i=0; i<s->n; i++) {
     if (sat_implied_literal(s->variables[i]->pos))
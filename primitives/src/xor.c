@@ -0,0 +1,536 @@
+#include "sat_api.h"
+#include "tools.h"
+
+/******************************************************************************
+* parity constraints
+*
+* xorDetect() looks among the cnf clauses of 3 to XOR_MAX_SIZE literals for
+* the clauses of an xor: over the same k variables, the 2^(k-1) clauses whose
+* negative literals have the same parity p forbid every value with that
+* parity, so the sum of the variables is !p
+* the xors are kept as the rows of a bit matrix, one column per variable,
+* brought to reduced row echelon form by Gauss-Jordan elimination: each row
+* has a basic column that no other row has
+* a row watches its basic column and one other column (not set, if any):
+* --a watched column that is set moves its watch to another one not set;
+*   when there is none, the row is unit (its basic column is implied) or
+*   fully set (it holds, or it is a conflict)
+* --a basic column that is set gives its row another basic column not set,
+*   which the other rows lose by adding the row to theirs; the matrix stays
+*   equivalent to the xors found, so nothing is undone when backtracking
+* the literal a row implies gets a reason clause spelled out from the row as
+* it is then (kept per column until the next implication), so is a conflict,
+* and conflict analysis uses them like any other clause
+* the cnf clauses of the xors stay: sat_unit_resolution() gives the literals
+* set to the rows only once the clauses imply nothing more, so the rows are
+* left with what the clauses cannot see; the columns set and their values
+* are bits as well, kept by literalAssign() and literalUnset()
+*******************************************************************************/
+// the sign patterns of an xor's clauses are bits of a uint64_t (seen in
+// xorDetect(), xorParityMask()), 2^XOR_MAX_VARS of them: it cannot go above 6
+typedef char XorMaxVarsCheck[XOR_MAX_VARS<=6 ? 1 : -1];
+
+/******************************************************************************
+* the xors of the cnf of the sat state become its rows, replacing any rows
+* it had
+*******************************************************************************/
+void xorDetect(SatState* sat_state) {
+  c2dSize i, j, k, run, size, count = 0, kept = 0, rows = 0, columns = 0;
+  c2dSize tableSize = 1;
+  c2dSize* table;
+  uint64_t* hashes;
+  uint64_t seen;
+  XorGroup* groups;
+  Clause* clause;
+  XorMatrix* matrix;
+  BOOLEAN parity;
+
+  xorFree(sat_state);
+  memset(&sat_state->xorStats, 0, sizeof(XorStats));
+  if (!XOR_GAUSS || sat_state->m==0)
+    return;
+
+  // the clauses that may be part of an xor, by a hash of their variables
+  hashes = (uint64_t*)malloc(sizeof(uint64_t)*sat_state->m);
+  for (i=0; i<sat_state->m; i++) {
+    clause = sat_state->delta[i];
+    hashes[i] = 0;
+    if (clause->size<3 || clause->size>XOR_MAX_SIZE)
+      continue;
+    for (j=0; j<clause->size; j++)
+      hashes[i] += xorMix((clause->codes[j]>>1)+1);
+    hashes[i] += clause->size;
+    count++;
+  }
+  while (tableSize<2*count)
+    tableSize *= 2;
+  table = (c2dSize*)calloc(tableSize, sizeof(c2dSize));
+  for (i=0; i<sat_state->m; i++)
+    if (hashes[i]!=0)
+      table[hashes[i]&(tableSize-1)]++;
+  groups = (XorGroup*)malloc(sizeof(XorGroup)*(count+1));
+  for (i=0; i<sat_state->m; i++) {
+    clause = sat_state->delta[i];
+    if (hashes[i]==0 || table[hashes[i]&(tableSize-1)] < ((c2dSize)1 << (clause->size-1)))
+      continue;
+    xorGroup(&groups[kept++], hashes[i], clause);
+  }
+  free(table);
+  free(hashes);
+
+  // the runs of clauses over the same variables, with all the signs of a parity
+  qsort(groups, kept, sizeof(XorGroup), xorCompare);
+  for (i=0; i<kept; i=run) {
+    seen = 0;
+    for (run=i; run<kept && xorCompare(&groups[i], &groups[run])==0; run++)
+      seen |= ((uint64_t)1) << groups[run].signs;
+    size = groups[i].size;
+    for (parity=0; parity<2; parity++)
+      if ((seen & xorParityMask(size, parity))==xorParityMask(size, parity)) {
+        groups[rows] = groups[i]; // the rows go first, over the runs already seen
+        groups[rows++].signs = !parity; // the sum of the variables
+      }
+  }
+  sat_state->xorStats.found = rows;
+  if (rows==0) {
+    free(groups);
+    return;
+  }
+
+  // the columns, the variables of the rows
+  matrix = (XorMatrix*)malloc(sizeof(XorMatrix));
+  matrix->varCol = (c2dSize*)malloc(sizeof(c2dSize)*sat_state->n);
+  for (i=0; i<sat_state->n; i++)
+    matrix->varCol[i] = XOR_NONE;
+  for (i=0; i<rows; i++)
+    for (j=0; j<groups[i].size; j++)
+      if (matrix->varCol[groups[i].vars[j]]==XOR_NONE)
+        matrix->varCol[groups[i].vars[j]] = columns++;
+  matrix->words = (columns+63)/64;
+  if (rows*matrix->words>XOR_MATRIX_LIMIT) {
+    free(matrix->varCol);
+    free(matrix);
+    free(groups);
+    return;
+  }
+  matrix->rows = rows;
+  matrix->columns = columns;
+  matrix->bits = (uint64_t*)calloc(rows*matrix->words, sizeof(uint64_t));
+  matrix->assigned = (uint64_t*)calloc(matrix->words, sizeof(uint64_t));
+  matrix->value = (uint64_t*)calloc(matrix->words, sizeof(uint64_t));
+  matrix->rhs = (BOOLEAN*)malloc(sizeof(BOOLEAN)*rows);
+  matrix->colVar = (c2dSize*)malloc(sizeof(c2dSize)*columns);
+  for (i=0; i<sat_state->n; i++)
+    if (matrix->varCol[i]!=XOR_NONE)
+      matrix->colVar[matrix->varCol[i]] = i;
+  for (i=0; i<rows; i++) {
+    for (j=0; j<groups[i].size; j++) {
+      k = matrix->varCol[groups[i].vars[j]];
+      XOR_ROW(matrix, i)[k/64] |= ((uint64_t)1) << (k%64);
+    }
+    matrix->rhs[i] = groups[i].signs;
+  }
+  free(groups);
+  xorEliminate(matrix);
+  sat_state->xorRows = matrix;
+  sat_state->xorStats.rows = matrix->rows;
+  sat_state->xorStats.columns = columns;
+}
+/******************************************************************************
+* the key of a clause that may be part of an xor: its variables in order, and
+* a bit for each of them that is negative
+*******************************************************************************/
+void xorGroup(XorGroup* group, uint64_t hash, Clause* clause) {
+  c2dSize i, j;
+  LitCode code;
+  LitCode codes[XOR_MAX_VARS];
+
+  for (i=0; i<clause->size; i++) { // insertion sort, by variable
+    code = clause->codes[i];
+    for (j=i; j>0 && codes[j-1]>code; j--)
+      codes[j] = codes[j-1];
+    codes[j] = code;
+  }
+  group->hash = hash;
+  group->size = clause->size;
+  group->signs = 0;
+  for (i=0; i<clause->size; i++) {
+    group->vars[i] = codes[i]>>1;
+    group->signs |= (codes[i]&1) << i;
+  }
+}
+int xorCompare(const void* a, const void* b) {
+  const XorGroup* x = (const XorGroup*)a;
+  const XorGroup* y = (const XorGroup*)b;
+  c2dSize i;
+
+  if (x->hash!=y->hash)
+    return x->hash<y->hash ? -1 : 1;
+  if (x->size!=y->size)
+    return x->size<y->size ? -1 : 1;
+  for (i=0; i<x->size; i++)
+    if (x->vars[i]!=y->vars[i])
+      return x->vars[i]<y->vars[i] ? -1 : 1;
+  return 0;
+}
+/******************************************************************************
+* a bit for each sign pattern of size literals whose negative literals have
+* the given parity
+*******************************************************************************/
+uint64_t xorParityMask(c2dSize size, BOOLEAN parity) {
+  c2dSize signs;
+  uint64_t mask = 0;
+
+  for (signs=0; signs<((c2dSize)1 << size); signs++)
+    if ((c2dSize)(__builtin_popcountll(signs)&1)==(c2dSize)parity)
+      mask |= ((uint64_t)1) << signs;
+  return mask;
+}
+uint64_t xorMix(uint64_t x) { // splitmix64, so the sum over the variables spreads
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+/******************************************************************************
+* xorEliminate :
+* Gauss-Jordan elimination, each row gets the first column it has left as
+* its basic column, which is removed from every other row
+* a row left empty is dropped (one that sums to 1 means the cnf has no model,
+* which its clauses show anyway), then each row watches a column other than
+* its basic one, if it has one
+*******************************************************************************/
+void xorEliminate(XorMatrix* matrix) {
+  c2dSize r, s, c, rows = 0;
+
+  matrix->basic = (c2dSize*)malloc(sizeof(c2dSize)*matrix->rows);
+  matrix->watch = (c2dSize*)malloc(sizeof(c2dSize)*matrix->rows);
+  matrix->basicRow = (c2dSize*)malloc(sizeof(c2dSize)*matrix->columns);
+  matrix->low = (c2dSize*)calloc(matrix->rows, sizeof(c2dSize));
+  matrix->high = (c2dSize*)malloc(sizeof(c2dSize)*matrix->rows);
+  matrix->watchers = (OccurList*)calloc(matrix->columns, sizeof(OccurList));
+  matrix->reasons = (Clause**)calloc(matrix->columns, sizeof(Clause*));
+  matrix->reasonCap = (c2dSize*)calloc(matrix->columns, sizeof(c2dSize));
+  matrix->conflict = NULL;
+  matrix->conflictCap = 0;
+  for (c=0; c<matrix->columns; c++)
+    matrix->basicRow[c] = XOR_NONE;
+  for (r=0; r<matrix->rows; r++)
+    matrix->high[r] = matrix->words;
+
+  for (r=0; r<matrix->rows; r++) {
+    c = xorFirst(matrix, r, XOR_NONE, XOR_NONE, NULL);
+    if (c==XOR_NONE)
+      continue;
+    for (s=0; s<matrix->rows; s++)
+      if (s!=r && XOR_BIT(matrix, s, c))
+        xorRowAdd(matrix, s, r);
+    if (r!=rows) { // rows left empty so far are dropped
+      memcpy(XOR_ROW(matrix, rows), XOR_ROW(matrix, r), sizeof(uint64_t)*matrix->words);
+      memset(XOR_ROW(matrix, r), 0, sizeof(uint64_t)*matrix->words);
+      matrix->rhs[rows] = matrix->rhs[r];
+      matrix->low[rows] = matrix->low[r];
+      matrix->high[rows] = matrix->high[r];
+    }
+    matrix->basic[rows] = c;
+    matrix->basicRow[c] = rows++;
+  }
+  matrix->rows = rows;
+  for (r=0; r<rows; r++) {
+    xorTrim(matrix, r);
+    matrix->watch[r] = xorFirst(matrix, r, matrix->basic[r], XOR_NONE, NULL);
+    if (matrix->watch[r]!=XOR_NONE)
+      occurAdd(&matrix->watchers[matrix->watch[r]], r);
+  }
+}
+void xorFree(SatState* sat_state) {
+  c2dSize c;
+  XorMatrix* matrix = sat_state->xorRows;
+
+  if (matrix==NULL)
+    return;
+  for (c=0; c<matrix->columns; c++) {
+    free(matrix->watchers[c].ids);
+    if (matrix->reasons[c]!=NULL)
+      free(matrix->reasons[c]->lits);
+    free(matrix->reasons[c]);
+  }
+  if (matrix->conflict!=NULL)
+    free(matrix->conflict->lits);
+  free(matrix->conflict);
+  free(matrix->watchers);
+  free(matrix->reasons);
+  free(matrix->reasonCap);
+  free(matrix->basic);
+  free(matrix->watch);
+  free(matrix->basicRow);
+  free(matrix->low);
+  free(matrix->high);
+  free(matrix->assigned);
+  free(matrix->value);
+  free(matrix->bits);
+  free(matrix->rhs);
+  free(matrix->colVar);
+  free(matrix->varCol);
+  free(matrix);
+  sat_state->xorRows = NULL;
+}
+/******************************************************************************
+* the first column of a row other than skip and other, not set when the sat
+* state is given
+* returns XOR_NONE if there is none
+*******************************************************************************/
+c2dSize xorFirst(XorMatrix* matrix, c2dSize row, c2dSize skip, c2dSize other, SatState* sat_state) {
+  c2dSize w, c;
+  uint64_t word;
+  uint64_t* bits = XOR_ROW(matrix, row);
+
+  for (w=matrix->low[row]; w<matrix->high[row]; w++) {
+    word = sat_state==NULL ? bits[w] : bits[w] & ~matrix->assigned[w];
+    for (; word!=0; word &= word-1) {
+      c = 64*w+__builtin_ctzll(word);
+      if (c!=skip && c!=other)
+        return c;
+    }
+  }
+  return XOR_NONE;
+}
+BOOLEAN xorAssigned(XorMatrix* matrix, c2dSize column, SatState* sat_state) {
+  return (matrix->assigned[column/64] >> (column%64)) & 1;
+}
+/******************************************************************************
+* xorAssign, xorUnassign :
+* the columns set, and their values, follow literalAssign() and literalUnset()
+*******************************************************************************/
+void xorAssign(LitCode code, SatState* sat_state) {
+  XorMatrix* matrix = sat_state->xorRows;
+  c2dSize c = matrix->varCol[code>>1];
+
+  if (c==XOR_NONE)
+    return;
+  matrix->assigned[c/64] |= ((uint64_t)1) << (c%64);
+  if ((code&1)==0)
+    matrix->value[c/64] |= ((uint64_t)1) << (c%64);
+}
+void xorUnassign(LitCode code, SatState* sat_state) {
+  XorMatrix* matrix = sat_state->xorRows;
+  c2dSize c = matrix->varCol[code>>1];
+
+  if (c==XOR_NONE)
+    return;
+  matrix->assigned[c/64] &= ~(((uint64_t)1) << (c%64));
+  matrix->value[c/64] &= ~(((uint64_t)1) << (c%64));
+}
+void xorRowAdd(XorMatrix* matrix, c2dSize row, c2dSize other) {
+  c2dSize w;
+  uint64_t* bits = XOR_ROW(matrix, row);
+  uint64_t* add = XOR_ROW(matrix, other);
+
+  if (matrix->low[other]<matrix->low[row])
+    matrix->low[row] = matrix->low[other];
+  if (matrix->high[other]>matrix->high[row])
+    matrix->high[row] = matrix->high[other];
+  for (w=matrix->low[other]; w<matrix->high[other]; w++)
+    bits[w] ^= add[w];
+  matrix->rhs[row] ^= matrix->rhs[other];
+  xorTrim(matrix, row);
+}
+/******************************************************************************
+* the words a row has bits in, from low to high, without zero words at
+* either end
+*******************************************************************************/
+void xorTrim(XorMatrix* matrix, c2dSize row) {
+  uint64_t* bits = XOR_ROW(matrix, row);
+
+  while (matrix->high[row]>matrix->low[row] && bits[matrix->high[row]-1]==0)
+    matrix->high[row]--;
+  while (matrix->low[row]<matrix->high[row] && bits[matrix->low[row]]==0)
+    matrix->low[row]++;
+}
+/******************************************************************************
+* xorSet :
+* lit was set, the rows with its variable are visited as explained above
+* returns 0 on a conflict
+*******************************************************************************/
+BOOLEAN xorSet(Lit* lit, SatState* sat_state) {
+  c2dSize i, j, r, s, y, w, size;
+  XorMatrix* matrix = sat_state->xorRows;
+  c2dSize c = matrix->varCol[lit->code>>1];
+  OccurList* list;
+
+  if (c==XOR_NONE)
+    return 1;
+  r = matrix->basicRow[c];
+  if (r!=XOR_NONE) { // another basic column for r
+    y = xorFirst(matrix, r, c, matrix->watch[r], sat_state);
+    if (y==XOR_NONE && matrix->watch[r]!=XOR_NONE && !xorAssigned(matrix, matrix->watch[r], sat_state))
+      y = matrix->watch[r];
+    if (y==XOR_NONE)
+      return xorSettle(matrix, r, sat_state);
+    matrix->basicRow[c] = XOR_NONE;
+    matrix->basicRow[y] = r;
+    matrix->basic[r] = y;
+    for (s=0; s<matrix->rows; s++) {
+      if (s==r || !XOR_BIT(matrix, s, y))
+        continue;
+      xorRowAdd(matrix, s, r);
+      w = matrix->watch[s];
+      if (w!=XOR_NONE && XOR_BIT(matrix, s, w) && !xorAssigned(matrix, w, sat_state))
+        continue; // its watch is still there, and not set
+      if (w!=XOR_NONE)
+        occurDelete(&matrix->watchers[w], s);
+      xorWatch(matrix, s, c, sat_state);
+    }
+    if (matrix->watch[r]==y) {
+      occurDelete(&matrix->watchers[y], r);
+      xorWatch(matrix, r, c, sat_state);
+    }
+    return !sat_state->conflict;
+  }
+
+  list = &matrix->watchers[c];
+  size = list->size;
+  for (i=0, j=0; i<size; i++) {
+    s = list->ids[i];
+    if (!sat_state->conflict) {
+      w = xorFirst(matrix, s, matrix->basic[s], c, sat_state);
+      if (w!=XOR_NONE) { // the watch moves
+        matrix->watch[s] = w;
+        occurAdd(&matrix->watchers[w], s);
+        continue;
+      }
+      xorSettle(matrix, s, sat_state);
+    }
+    list->ids[j++] = s;
+  }
+  list->size = j;
+  return !sat_state->conflict;
+}
+/******************************************************************************
+* a row whose watch lost its column to the row added to it (or was set) gets
+* a column not set to watch, else the column set given, and is settled
+*******************************************************************************/
+void xorWatch(XorMatrix* matrix, c2dSize row, c2dSize set, SatState* sat_state) {
+  c2dSize w = xorFirst(matrix, row, matrix->basic[row], XOR_NONE, sat_state);
+
+  if (w==XOR_NONE && XOR_BIT(matrix, row, set))
+    w = set;
+  if (w==XOR_NONE)
+    w = xorFirst(matrix, row, matrix->basic[row], XOR_NONE, NULL);
+  matrix->watch[row] = w;
+  if (w!=XOR_NONE)
+    occurAdd(&matrix->watchers[w], row);
+  if (w==XOR_NONE || xorAssigned(matrix, w, sat_state))
+    xorSettle(matrix, row, sat_state);
+}
+/******************************************************************************
+* xorSettle :
+* every column of a row but maybe its basic one is set: the basic column is
+* implied, or the row holds, or it is a conflict
+* returns 0 on a conflict
+*******************************************************************************/
+BOOLEAN xorSettle(XorMatrix* matrix, c2dSize row, SatState* sat_state) {
+  c2dSize w;
+  c2dSize size = 0;
+  c2dSize opens = 0;
+  c2dSize open = XOR_NONE;
+  uint64_t word;
+  uint64_t* bits = XOR_ROW(matrix, row);
+  LitCode code;
+  BOOLEAN sum = matrix->rhs[row];
+  Clause* clause;
+
+  if (sat_state->conflict)
+    return 0;
+  for (w=matrix->low[row]; w<matrix->high[row]; w++) {
+    size += __builtin_popcountll(bits[w]);
+    sum ^= __builtin_popcountll(bits[w] & matrix->value[w]) & 1;
+    word = bits[w] & ~matrix->assigned[w];
+    if (word!=0) {
+      opens += __builtin_popcountll(word);
+      open = 64*w+__builtin_ctzll(word);
+    }
+  }
+  if (opens>1) // not settled yet
+    return 1;
+  if (open!=XOR_NONE) {
+    code = 2*matrix->colVar[open]+!sum;
+    matrix->reasons[open] = xorClause(matrix->reasons[open], size, &matrix->reasonCap[open]);
+    clause = xorExplain(matrix, row, code, matrix->reasons[open], sat_state);
+    literalAssign(&sat_state->literals[code], (Reason)clause, sat_state);
+    sat_state->xorStats.implied++;
+    return 1;
+  }
+  if (!sum)
+    return 1;
+  matrix->conflict = xorClause(matrix->conflict, size, &matrix->conflictCap);
+  clause = xorExplain(matrix, row, XOR_NONE, matrix->conflict, sat_state);
+  sat_state->xorStats.conflicts++;
+  sat_state->conflict = 1;
+  conflictFound(clause, sat_state);
+  return 0;
+}
+/******************************************************************************
+* the clause of a row as it is set: implied (unless XOR_NONE) followed by the
+* false literal of every other column, written into clause
+*******************************************************************************/
+Clause* xorExplain(XorMatrix* matrix, c2dSize row, c2dSize implied, Clause* clause, SatState* sat_state) {
+  c2dSize w, c;
+  c2dSize size = 0;
+  uint64_t word;
+  uint64_t* bits = XOR_ROW(matrix, row);
+  LitCode code;
+
+  free(clause->lits); // the literal array of sat_clause_literals() is for the old size
+  clause->lits = NULL;
+  if (implied!=XOR_NONE)
+    clause->codes[size++] = implied;
+  for (w=matrix->low[row]; w<matrix->high[row]; w++)
+    for (word=bits[w]; word!=0; word &= word-1) {
+      c = 64*w+__builtin_ctzll(word);
+      code = 2*matrix->colVar[c];
+      if (implied!=XOR_NONE && (code>>1)==(implied>>1))
+        continue;
+      clause->codes[size++] = sat_state->litLevel[code]>0 ? code+1 : code;
+    }
+  clause->size = size;
+  clause->table = sat_state->literals;
+  return clause;
+}
+/******************************************************************************
+* a clause with room for size literals, that is not part of the cnf: clause
+* itself when it has room already (cap), else it grows
+*******************************************************************************/
+Clause* xorClause(Clause* clause, c2dSize size, c2dSize* cap) {
+  if (size<=*cap)
+    return clause;
+  *cap = size>2*(*cap) ? size : 2*(*cap);
+  clause = (Clause*)realloc(clause, CLAUSE_BYTES(*cap));
+  clause->index = 0;
+  clause->size = 0;
+  clause->table = NULL;
+  clause->lits = NULL; // freed by xorExplain()
+  clause->setLevel = 0;
+  clause->activity = 0;
+  clause->lbd = 0;
+  clause->removed = 0;
+  clause->imported = 0;
+  clause->mark = 0;
+  return clause;
+}
+/******************************************************************************
+* the rows of one column, set when unit resolution starts at level 1
+* returns 0 on a conflict
+*******************************************************************************/
+BOOLEAN xorUnits(SatState* sat_state) {
+  c2dSize r;
+  XorMatrix* matrix = sat_state->xorRows;
+
+  for (r=0; r<matrix->rows && !sat_state->conflict; r++)
+    if (matrix->watch[r]==XOR_NONE)
+      xorSettle(matrix, r, sat_state);
+  return !sat_state->conflict;
+}
+/******************************************************************************
+ * end
+ ******************************************************************************/
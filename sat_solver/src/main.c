@@ -1,76 +1,497 @@
-#include "sat_api.h"
-
-#include <stdio.h>
-#include <sys/times.h>
-#include <unistd.h>
-#include <stdlib.h>
-
-/******************************************************************************
- * SAT solver 
- ******************************************************************************/
-
-//returns a literal which is free in the current setting of sat state  
-//a NAIVE implementation no one would use in practice
-//you are free to modify this (no need though)
-Lit* get_free_literal(SatState* sat_state) {
-  c2dSize var_count = sat_var_count(sat_state);
-  for(c2dSize i=0; i<var_count; i++) { //go over variables
-    Var* var  = sat_index2var(i+1,sat_state); //note index is i+1, not i
-    Lit* plit = sat_pos_literal(var);
-    Lit* nlit = sat_neg_literal(var);
-    if(!sat_implied_literal(plit) && !sat_implied_literal(nlit)) return plit;
-  }
-  return NULL; //all literals are implied
-}
-
-//if sat state is shown to be satisfiable, it returns NULL
-//otherwise, a clause must be learned and it is returned
-Clause* sat_aux(SatState* sat_state) {
-  Lit* lit = get_free_literal(sat_state);
-  if(lit==NULL) return NULL; //all literals are implied
-
-  Clause* learned = sat_decide_literal(lit,sat_state);
-  if(learned==NULL) learned = sat_aux(sat_state);
-  sat_undo_decide_literal(sat_state);
-
-  if(learned!=NULL) { //there is a conflict
-    if(sat_at_assertion_level(learned,sat_state)) {
-      learned = sat_assert_clause(learned,sat_state);
-      if(learned==NULL) return sat_aux(sat_state); //try again
-      else return learned; //new clause learned, backtrack
-    }
-    else return learned; //backtrack (still conflict)
-  }
-  return NULL; //satisfiable
-}
-
-BOOLEAN sat(SatState* sat_state) {
-  BOOLEAN ret = 0;
-  if(sat_unit_resolution(sat_state)) ret = (sat_aux(sat_state)==NULL? 1: 0);
-  sat_undo_unit_resolution(sat_state); // everything goes back to the initial state
-  return ret;
-}
-
-int main(int argc, char* argv[]) {  
-  char USAGE_MSG[] = "Usage: ./sat -c <cnf_file>\n";
-  char* cnf_fname  = NULL;
-
-  if(argc==3 && strcmp("-c",argv[1])==0) cnf_fname = argv[2];
-  else {
-    printf("%s",USAGE_MSG);
-    exit(1);
-  }
-
-  //construct a sat state and then check satisfiability
-  SatState* sat_state = sat_state_new(cnf_fname);
-  if(sat(sat_state)) printf("SAT\n");
-  else printf("UNSAT\n");
-  printf("Learned: %ld\n", sat_state->l);
-  sat_state_free(sat_state);
-
-  return 0;
-}
-
-/******************************************************************************
- * end
- ******************************************************************************/
+#include "sat_api.h"
+
+#include <stdio.h>
+#include <sys/times.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/******************************************************************************
+ * SAT solver 
+ ******************************************************************************/
+
+//returns a literal which is free in the current setting of sat state
+//the variable with the highest activity (kept in a heap by libsat), in the phase of the sat state (PHASE by default)
+Lit* get_free_literal(SatState* sat_state) {
+  return sat_next_decision(sat_state); //NULL when all literals are implied
+}
+
+//keeps the values of the variables when all literals are implied
+void save_model(SatState* sat_state, BOOLEAN* model) {
+  c2dSize var_count = sat_var_count(sat_state);
+  for(c2dSize i=0; i<var_count; i++)
+    model[i] = sat_implied_literal(sat_pos_literal(sat_index2var(i+1,sat_state)));
+}
+
+//restart policies of the search, see -r
+typedef enum { RESTART_NONE, RESTART_LUBY, RESTART_GLUCOSE } RestartPolicy;
+
+#define GLUCOSE_MIN 50 //conflicts a glucose run has at least
+#define GLUCOSE_MARGIN 1.25 //a glucose run ends once the recent lbds are that much above the long run ones
+#define GLUCOSE_BLOCK 1.4 //a conflict with that many more literals set than usual starts the run again
+#define GLUCOSE_BLOCK_MIN 10000 //conflicts before runs are started again that way
+
+typedef struct {
+  RestartPolicy policy;
+  c2dSize conflicts; //in all
+  c2dSize count; //restarts so far
+  c2dSize run; //conflicts since the last restart
+  double fast; //moving average of the lbds of the last learned clauses (about 32)
+  double slow; //moving average of the lbds of many learned clauses (about 4096)
+  double trail; //moving average of the literals set at conflicts (about 5000)
+} Restarts;
+
+//a clause of this lbd was learned, on a conflict with trail literals set
+//a glucose run is started again when the search may be close to a model (the trail is much
+//larger than usual), rather than ended by the next restart
+void restart_conflict(Restarts* restarts, c2dSize lbd, c2dSize trail) {
+  restarts->conflicts++;
+  restarts->run++;
+  if(restarts->conflicts==1) {
+    restarts->fast = restarts->slow = lbd;
+    restarts->trail = trail;
+  }
+  restarts->fast += (lbd-restarts->fast)/32;
+  restarts->slow += (lbd-restarts->slow)/4096;
+  if(restarts->policy==RESTART_GLUCOSE && restarts->conflicts>GLUCOSE_BLOCK_MIN
+     && trail>GLUCOSE_BLOCK*restarts->trail) restarts->run = 0;
+  restarts->trail += (trail-restarts->trail)/5000;
+}
+
+//whether the search should go back to level 1, then a new run starts
+BOOLEAN restart_due(Restarts* restarts) {
+  BOOLEAN due = 0;
+  switch(restarts->policy) {
+    case RESTART_NONE:
+      break;
+    case RESTART_LUBY:
+      due = restarts->run>=RESTART_UNIT*sat_luby(restarts->count+1);
+      break;
+    case RESTART_GLUCOSE:
+      due = restarts->run>=GLUCOSE_MIN && restarts->fast>GLUCOSE_MARGIN*restarts->slow;
+      break;
+  }
+  if(due) {
+    restarts->count++;
+    restarts->run = 0;
+  }
+  return due;
+}
+
+/******************************************************************************
+ * Portfolio: with -t, several threads search the cnf at once, each on a sat state of its own (a
+ * worker), and the first answer ends them all
+ * --the sat states of the workers other than the first are built in memory from the clauses of
+ *   the first one as parsed (sat_state_from_clauses()), so the input is read once, and may be a pipe
+ * --the workers differ by the order of their first decisions (sat_seed_order()), their restart
+ *   policy and their phase; the first one is the solver of one thread, -r and PHASE
+ * --they share the learned clauses of lbd at most SHARE_LBD (units and binary clauses with them):
+ *   each worker appends them to a ring of its own, and adds those of the others at its restarts
+ *   with sat_import_clause(), as learned clauses its reduction may delete (a worker that does not
+ *   restart, -r none, only exports)
+ * --with -p, a clause learned on the simplified cnf need not follow from the cnf as given, since
+ *   variable elimination only keeps it equisatisfiable; sharing is sound because every worker gets
+ *   the same simplified cnf, from the same deterministic simplify() on the same clauses (its work,
+ *   probing included, is bounded by counts, not by time), and any difference among the workers in
+ *   the way they simplify would make it unsound; the equivalent literals a worker substitutes at its
+ *   restarts follow from that cnf and its learned clauses, so its clauses still follow from that cnf
+ * with one thread there is no other worker to import from, and the search, -p included, is the
+ * same from one run to the next
+ ******************************************************************************/
+
+//answers of a search, unknown when another worker answered first
+typedef enum { ANSWER_UNKNOWN, ANSWER_SAT, ANSWER_UNSAT } Answer;
+
+#define SHARE_LBD 2 //learned clauses of at most that lbd are exported
+#define SHARE_MAX 30 //longest clause exported
+#define SHARE_RING (1UL<<16) //words of the ring of a worker, a power of 2
+
+//the clauses a worker exported, each as its size and its lbd followed by its literals, a word at its place
+//modulo SHARE_RING; without locks, since only the worker writes: it moves writing to the end of
+//the clause before it writes the clause, then written once it is written, so a reader copies up
+//to written, and what it copied from before writing-SHARE_RING may have been overwritten meanwhile
+typedef struct {
+  c2dSize writing;
+  c2dSize written;
+  c2dLiteral words[SHARE_RING];
+} Ring;
+
+typedef struct portfolio Portfolio;
+
+typedef struct {
+  Portfolio* portfolio;
+  c2dSize id; //from 0
+  SatState* sat_state;
+  BOOLEAN* model;
+  Restarts restarts;
+  BOOLEAN phase;
+  c2dSize* read; //per worker: the words of its ring this one imported
+  c2dSize exported;
+  c2dSize imported;
+  c2dSize substituted; //conflicts at the last substitution of equivalent literals
+  pthread_t thread;
+  Ring ring;
+} Worker;
+
+struct portfolio {
+  Worker* workers;
+  c2dSize count;
+  c2dSize var_count; //the cnf as parsed, for the sat states of the workers but the first
+  c2dSize clause_count;
+  c2dSize* sizes;
+  c2dLiteral* literals;
+  BOOLEAN preprocess;
+  int answer; //ANSWER_UNKNOWN until a worker finds one
+  c2dSize winner; //the worker that found it
+};
+
+//whether a worker found the answer
+BOOLEAN portfolio_done(Portfolio* portfolio) {
+  return __atomic_load_n(&portfolio->answer,__ATOMIC_RELAXED)!=ANSWER_UNKNOWN;
+}
+
+//the first answer of a worker is the answer of the portfolio, the worker (and its model) are kept
+void portfolio_answer(Worker* worker, Answer answer) {
+  int unknown = ANSWER_UNKNOWN;
+  if(answer!=ANSWER_UNKNOWN && __atomic_compare_exchange_n(&worker->portfolio->answer,&unknown,(int)answer,0,
+                                                           __ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE))
+    worker->portfolio->winner = worker->id;
+}
+
+//appends a clause the worker learned to its ring, if it is one to share
+void share_export(Worker* worker, Clause* clause) {
+  Ring* ring = &worker->ring;
+  c2dSize size = sat_clause_size(clause);
+  if(worker->portfolio->count==1 || size>SHARE_MAX || sat_clause_lbd(clause)>SHARE_LBD) return;
+  c2dSize start = ring->written;
+  __atomic_store_n(&ring->writing,start+size+2,__ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE); //readers see writing move before the words change
+  __atomic_store_n(&ring->words[start&(SHARE_RING-1)],(c2dLiteral)size,__ATOMIC_RELAXED);
+  __atomic_store_n(&ring->words[(start+1)&(SHARE_RING-1)],(c2dLiteral)sat_clause_lbd(clause),__ATOMIC_RELAXED);
+  for(c2dSize i=0; i<size; i++)
+    __atomic_store_n(&ring->words[(start+2+i)&(SHARE_RING-1)],sat_clause_literal_index(i,clause),__ATOMIC_RELAXED);
+  __atomic_store_n(&ring->written,start+size+2,__ATOMIC_RELEASE);
+  worker->exported++;
+}
+
+//adds the clauses the other workers exported since the last call, at level 1 (clauses overwritten
+//before they were read are lost)
+//returns 0 if it then finds the cnf unsatisfiable
+BOOLEAN share_import(Worker* worker) {
+  Portfolio* portfolio = worker->portfolio;
+  c2dLiteral literals[SHARE_MAX];
+  for(c2dSize w=0; w<portfolio->count; w++) {
+    if(w==worker->id) continue;
+    Ring* ring = &portfolio->workers[w].ring;
+    c2dSize written = __atomic_load_n(&ring->written,__ATOMIC_ACQUIRE);
+    c2dSize start = worker->read[w];
+    while(start<written) {
+      c2dSize size = (c2dSize)__atomic_load_n(&ring->words[start&(SHARE_RING-1)],__ATOMIC_RELAXED);
+      if(size>SHARE_MAX) size = 0; //overwritten, found below
+      c2dSize lbd = (c2dSize)__atomic_load_n(&ring->words[(start+1)&(SHARE_RING-1)],__ATOMIC_RELAXED);
+      for(c2dSize i=0; i<size; i++)
+        literals[i] = __atomic_load_n(&ring->words[(start+2+i)&(SHARE_RING-1)],__ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE); //the words were copied before writing is read
+      if(size==0 || __atomic_load_n(&ring->writing,__ATOMIC_RELAXED)-start>SHARE_RING) {
+        start = written;
+        break;
+      }
+      worker->imported++;
+      if(!sat_import_clause(literals,size,lbd,worker->sat_state)) return 0;
+      start += size+2;
+    }
+    worker->read[w] = start;
+  }
+  return 1;
+}
+
+#define SUBSTITUTE_CONFLICTS 10000 //with -p, conflicts between two substitutions of equivalent literals
+
+//with -p, at a restart once SUBSTITUTE_CONFLICTS conflicts went by since the last time: the learned
+//binary clauses may make more literals equivalent, each class is then replaced by one of its literals
+//in the cnf and learned clauses (sat_substitute_equivalences(), with unit resolution undone)
+//returns 0 if it then finds the cnf unsatisfiable
+BOOLEAN substitute_equivalences(Worker* worker) {
+  SatState* sat_state = worker->sat_state;
+  if(!worker->portfolio->preprocess || worker->restarts.conflicts-worker->substituted<SUBSTITUTE_CONFLICTS) return 1;
+  worker->substituted = worker->restarts.conflicts;
+  sat_undo_unit_resolution(sat_state);
+  return sat_substitute_equivalences(sat_state) && sat_unit_resolution(sat_state);
+}
+
+//decides literals until all are implied (satisfiable, the model of the worker is set) or a conflict
+//is found at level 1 (unsatisfiable); on a conflict it backjumps to the assertion level of the learned
+//clause and asserts it there, and it restarts when the policy says so (with -p substituting the
+//equivalent literals found meanwhile)
+//it stops, with no answer, once another worker has one
+Answer search(Worker* worker) {
+  SatState* sat_state = worker->sat_state;
+  while(!portfolio_done(worker->portfolio)) {
+    Lit* lit = get_free_literal(sat_state);
+    if(lit==NULL) { //all literals are implied
+      save_model(sat_state,worker->model);
+      return ANSWER_SAT;
+    }
+    Clause* learned = sat_decide_literal(lit,sat_state);
+    while(learned!=NULL) { //there is a conflict
+      c2dSize level = sat_assertion_level(learned,sat_state);
+      if(level==0) return ANSWER_UNSAT; //the empty clause
+      restart_conflict(&worker->restarts,sat_clause_lbd(learned),sat_state->setCount);
+      share_export(worker,learned);
+      sat_backtrack(level,sat_state);
+      learned = sat_assert_clause(learned,sat_state); //a new clause learned if not NULL
+    }
+    if(restart_due(&worker->restarts)) {
+      sat_backtrack(1,sat_state);
+      if(!substitute_equivalences(worker) || !share_import(worker)) return ANSWER_UNSAT;
+    }
+  }
+  return ANSWER_UNKNOWN;
+}
+
+Answer sat(Worker* worker) {
+  SatState* sat_state = worker->sat_state;
+  Answer answer = ANSWER_UNSAT;
+  if(sat_unit_resolution(sat_state)) {
+    answer = search(worker);
+    sat_backtrack(1,sat_state);
+  }
+  sat_undo_unit_resolution(sat_state); // everything goes back to the initial state
+  return answer;
+}
+
+void print_preprocessing(SatState* sat_state) {
+  PrepStats* stats = &sat_state->prepStats;
+  printf("Preprocessed: %ld -> %ld clauses, %ld -> %ld variables in %0.3fs\n", stats->clausesBefore,
+         stats->clausesAfter, stats->varsBefore, stats->varsAfter, stats->time);
+  printf("  equivalences: %ld variables substituted in %0.3fs\n", stats->substituted, stats->substituteTime);
+  printf("  units: %ld variables set\n", stats->fixed);
+  printf("  subsumption: %ld clauses subsumed, %ld literals strengthened in %0.3fs\n",
+         stats->subsumed, stats->strengthened, stats->subsumeTime);
+  printf("  elimination: %ld variables eliminated (%ld defined by gates), %ld resolvents in %0.3fs\n",
+         stats->eliminated, stats->gates, stats->resolvents, stats->eliminateTime);
+}
+
+void print_probing(SatState* sat_state) {
+  ProbeStats* stats = &sat_state->probeStats;
+  printf("Probed: %ld literals, %ld failed, %ld lifted, %ld hyper-binary resolvents in %0.3fs\n",
+         stats->probed, stats->failed, stats->lifted, stats->hyper, stats->time);
+}
+
+void print_cardinality(SatState* sat_state) {
+  CardStats* stats = &sat_state->cardStats;
+  printf("Cardinality: %ld at-most-one constraints (%ld exactly-one) over %ld literals, for %ld binary clauses in %0.3fs\n",
+         stats->groups, stats->exactlyOne, stats->literals, stats->binaries, stats->time);
+}
+
+void print_xors(SatState* sat_state) {
+  XorStats* stats = &sat_state->xorStats;
+  printf("Xors: %ld found, %ld rows over %ld variables, %ld implied, %ld conflicts\n",
+         stats->found, stats->rows, stats->columns, stats->implied, stats->conflicts);
+}
+
+//the simplifications of -p, before the search
+//returns 0 if they find the cnf unsatisfiable
+BOOLEAN simplify(SatState* sat_state, BOOLEAN print) {
+  BOOLEAN satisfiable = sat_preprocess(sat_state);
+  if(print) print_preprocessing(sat_state);
+  if(satisfiable) {
+    sat_cardinality(sat_state);
+    if(print) print_cardinality(sat_state);
+    satisfiable = sat_unit_resolution(sat_state) && sat_probe(sat_state);
+    sat_undo_unit_resolution(sat_state); //the literals set are learned as unit clauses
+    if(print) print_probing(sat_state);
+  }
+  return satisfiable;
+}
+
+//the settings of a worker: the first one follows -r and PHASE, the others take turns between the
+//luby and glucose policies, and the target and saved phases, and each has its own decision order
+void worker_init(Worker* worker, Portfolio* portfolio, c2dSize id, RestartPolicy policy) {
+  worker->portfolio = portfolio;
+  worker->id = id;
+  worker->restarts.policy = id==0 ? policy : id%2 ? RESTART_GLUCOSE : RESTART_LUBY;
+  worker->phase = id==0 ? PHASE : id%4<2 ? 2 : 1;
+  worker->read = (c2dSize*)calloc(portfolio->count, sizeof(c2dSize));
+}
+
+//keeps the clauses of the cnf as parsed, before the first worker simplifies its sat state (also for
+//the backbone with -p)
+void portfolio_cnf(Portfolio* portfolio, SatState* sat_state) {
+  c2dSize total = 0;
+  portfolio->var_count = sat_var_count(sat_state);
+  portfolio->clause_count = sat_clause_count(sat_state);
+  portfolio->sizes = (c2dSize*)malloc(sizeof(c2dSize)*(portfolio->clause_count+1));
+  for(c2dSize i=0; i<portfolio->clause_count; i++) {
+    portfolio->sizes[i] = sat_clause_size(sat_index2clause(i+1,sat_state));
+    total += portfolio->sizes[i];
+  }
+  portfolio->literals = (c2dLiteral*)malloc(sizeof(c2dLiteral)*(total+1));
+  total = 0;
+  for(c2dSize i=0; i<portfolio->clause_count; i++) {
+    Clause* clause = sat_index2clause(i+1,sat_state);
+    for(c2dSize j=0; j<portfolio->sizes[i]; j++) portfolio->literals[total++] = sat_clause_literal_index(j,clause);
+  }
+}
+
+//the search of a worker other than the first: its sat state from the clauses of the cnf as parsed,
+//simplified like the one of the first worker (without printing)
+void* worker_run(void* arg) {
+  Worker* worker = (Worker*)arg;
+  Portfolio* portfolio = worker->portfolio;
+  SatState* sat_state = sat_state_from_clauses(portfolio->var_count,portfolio->clause_count,
+                                               portfolio->sizes,portfolio->literals);
+  worker->sat_state = sat_state;
+  if(sat_state==NULL || portfolio_done(portfolio)) return NULL;
+  worker->model = (BOOLEAN*)calloc(sat_var_count(sat_state)+1, sizeof(BOOLEAN));
+  if(portfolio->preprocess && !simplify(sat_state,0)) {
+    portfolio_answer(worker,ANSWER_UNSAT);
+    return NULL;
+  }
+  sat_set_phase(worker->phase,sat_state);
+  sat_seed_order(worker->id,sat_state);
+  portfolio_answer(worker,sat(worker));
+  return NULL;
+}
+
+int main(int argc, char* argv[]) {  
+  char USAGE_MSG[] = "Usage: ./sat -c <cnf_file> [-p] [-b] [-m] [-r <restarts>] [-t <threads>] [-s <snapshot_file>]\n"
+                     "  -p  preprocess the cnf, find its at-most-one constraints, then probe its literals\n"
+                     "  -b  print the backbone (b line), the literals true in all models\n"
+                     "  -m  print a model (v line) when satisfiable\n"
+                     "  -r  restart policy: luby (default), glucose (by the lbds of the learned clauses), or none\n"
+                     "  -t  threads searching at once, each its own way, sharing their learned clauses (default 1)\n";
+  char* cnf_fname  = NULL;
+  char* snapshot_fname = NULL;
+  BOOLEAN preprocess = 0;
+  BOOLEAN print_model = 0;
+  BOOLEAN print_backbone = 0;
+  RestartPolicy policy = RESTART_LUBY;
+  long threads = 1;
+
+  for(int i=1; i<argc; i++) {
+    if(strcmp("-c",argv[i])==0 && i+1<argc) cnf_fname = argv[++i];
+    else if(strcmp("-s",argv[i])==0 && i+1<argc) snapshot_fname = argv[++i];
+    else if(strcmp("-p",argv[i])==0) preprocess = 1;
+    else if(strcmp("-m",argv[i])==0) print_model = 1;
+    else if(strcmp("-b",argv[i])==0) print_backbone = 1;
+    else if(strcmp("-r",argv[i])==0 && i+1<argc) {
+      char* name = argv[++i];
+      if(strcmp("glucose",name)==0) policy = RESTART_GLUCOSE;
+      else if(strcmp("luby",name)==0) policy = RESTART_LUBY;
+      else if(strcmp("none",name)==0) policy = RESTART_NONE;
+      else {
+        printf("%s",USAGE_MSG);
+        exit(1);
+      }
+    }
+    else if(strcmp("-t",argv[i])==0 && i+1<argc) {
+      threads = atol(argv[++i]);
+      if(threads<1) {
+        printf("%s",USAGE_MSG);
+        exit(1);
+      }
+    }
+    else {
+      printf("%s",USAGE_MSG);
+      exit(1);
+    }
+  }
+  if(cnf_fname==NULL) {
+    printf("%s",USAGE_MSG);
+    exit(1);
+  }
+
+  //construct a sat state and then check satisfiability
+  SatState* sat_state = sat_state_new(cnf_fname);
+  if(sat_state==NULL) exit(1);
+  printf("Parsed: %ld bytes in %0.3fs (%0.1f MB/s)\n", sat_state->parseBytes, sat_state->parseTime,
+         sat_state->parseTime>0 ? sat_state->parseBytes/sat_state->parseTime/1e6 : 0.0);
+  if(snapshot_fname!=NULL) { //only convert the cnf, sat_state_new() loads the snapshot without parsing
+    BOOLEAN saved = sat_state_save(sat_state, snapshot_fname);
+    if(saved) printf("Snapshot: %s\n", snapshot_fname);
+    else printf("Could not write snapshot: %s\n", snapshot_fname);
+    sat_state_free(sat_state);
+    return saved ? 0 : 1;
+  }
+
+  //the first worker runs here, on this sat state, the others in threads of their own
+  Portfolio portfolio = { NULL, (c2dSize)threads, 0, 0, NULL, NULL, preprocess, ANSWER_UNKNOWN, 0 };
+  portfolio.workers = (Worker*)calloc(portfolio.count, sizeof(Worker));
+  if(portfolio.count>1 || (preprocess && print_backbone)) portfolio_cnf(&portfolio,sat_state);
+  for(c2dSize i=0; i<portfolio.count; i++) worker_init(&portfolio.workers[i],&portfolio,i,policy);
+  Worker* first = &portfolio.workers[0];
+  first->sat_state = sat_state;
+  first->model = (BOOLEAN*)calloc(sat_var_count(sat_state)+1, sizeof(BOOLEAN));
+  for(c2dSize i=1; i<portfolio.count; i++)
+    if(pthread_create(&portfolio.workers[i].thread,NULL,worker_run,&portfolio.workers[i])!=0) {
+      printf("Could not start thread %ld\n", (long)i);
+      exit(1);
+    }
+
+  BOOLEAN satisfiable = 1;
+  if(print_backbone) {
+    //the backbone of the cnf as given: preprocessing sets and takes out variables the b line must
+    //have, and wants no learned clauses, so with -p it is found on a sat state of its own, built
+    //from the clauses as parsed
+    SatState* given = preprocess ? sat_state_from_clauses(portfolio.var_count,portfolio.clause_count,
+                                                          portfolio.sizes,portfolio.literals) : sat_state;
+    Lit** backbone = (Lit**)malloc(sizeof(Lit*)*(sat_var_count(given)+1));
+    c2dSize count = 0;
+    satisfiable = sat_unit_resolution(given) && sat_backbone(backbone,&count,given);
+    if(satisfiable) {
+      printf("b");
+      for(c2dSize i=0; i<count; i++) printf(" %ld", sat_literal_index(backbone[i]));
+      printf(" 0\n");
+    }
+    sat_undo_unit_resolution(given);
+    free(backbone);
+    if(given!=sat_state) sat_state_free(given);
+  }
+  if(satisfiable && preprocess) satisfiable = simplify(sat_state,1);
+  portfolio_answer(first, satisfiable ? sat(first) : ANSWER_UNSAT);
+  for(c2dSize i=1; i<portfolio.count; i++) pthread_join(portfolio.workers[i].thread,NULL);
+
+  //the answer of the portfolio, from the worker that found it
+  Worker* winner = &portfolio.workers[portfolio.winner];
+  sat_state = winner->sat_state;
+  satisfiable = portfolio.answer==ANSWER_SAT;
+  if(satisfiable) printf("SAT\n");
+  else printf("UNSAT\n");
+  if(satisfiable && print_model) {
+    sat_extend_model(sat_state,winner->model); //values of the variables preprocessing took out
+    printf("v");
+    for(c2dSize i=0; i<sat_var_count(sat_state); i++) printf(" %ld", winner->model[i] ? (long)i+1 : -(long)i-1);
+    printf(" 0\n");
+  }
+  if(portfolio.count>1) {
+    c2dSize exported = 0, imported = 0;
+    for(c2dSize i=0; i<portfolio.count; i++) {
+      exported += portfolio.workers[i].exported;
+      imported += portfolio.workers[i].imported;
+    }
+    printf("Portfolio: %ld threads, answer by thread %ld, %ld clauses shared (%ld imported)\n",
+           portfolio.count, winner->id, exported, imported);
+  }
+  printf("Conflicts: %ld (%ld restarts)\n", winner->restarts.conflicts, winner->restarts.count);
+  printf("Learned: %ld (%ld deleted)\n", sat_state->l+sat_state->deleted, sat_state->deleted);
+  printf("Minimized: %ld (local) %ld (recursive)\n", sat_state->minLocal, sat_state->minRecursive);
+  if(sat_state->xorStats.found>0) print_xors(sat_state);
+  if(sat_state->cardStats.groups>0)
+    printf("At-most-one: %ld implied, %ld conflicts\n", sat_state->cardStats.implied, sat_state->cardStats.conflicts);
+  for(c2dSize i=0; i<portfolio.count; i++) {
+    Worker* worker = &portfolio.workers[i];
+    free(worker->model);
+    free(worker->read);
+    if(worker->sat_state!=NULL) sat_state_free(worker->sat_state);
+  }
+  free(portfolio.workers);
+  free(portfolio.sizes);
+  free(portfolio.literals);
+
+  return 0;
+}
+
+/******************************************************************************
+ * end
+ ******************************************************************************/
@@ -0,0 +1,72 @@
+#include "sat_api.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/******************************************************************************
+ * checks of the libsat api on small cnfs built in memory, see README; prints
+ * each error and returns 1 if there is one
+ ******************************************************************************/
+
+int errors = 0;
+
+void check(BOOLEAN test, const char* what) {
+  if(!test) {
+    errors++;
+    printf("%s\n", what);
+  }
+}
+
+//the answer of sat_solve() without assumptions
+BOOLEAN solved(SatState* sat_state) {
+  c2dSize failed_count = 0;
+  return sat_solve(NULL,0,NULL,NULL,&failed_count,sat_state);
+}
+
+//(1 2) (-1 3) (-2 3) (1 -3 4) and then -3 from sat_add_clause(), unsatisfiable:
+//preprocessing and saving must refuse the sat state (preprocessing with 2, not 0 for unsatisfiable),
+//not drop the clause; with 3 added instead, it is refused and still satisfiable
+void check_added_clause() {
+  c2dSize sizes[] = { 2, 2, 2, 3 };
+  c2dLiteral literals[] = { 1, 2, -1, 3, -2, 3, 1, -3, 4 };
+  c2dLiteral unit[] = { -3 };
+  c2dLiteral other[] = { 3 };
+  SatState* sat_state = sat_state_from_clauses(4,4,sizes,literals);
+
+  check(sat_preprocess(sat_state)==1 && solved(sat_state), "added clause: the cnf is unsatisfiable");
+  sat_state_free(sat_state);
+  sat_state = sat_state_from_clauses(4,4,sizes,literals);
+  check(sat_add_clause(other,1,sat_state) && sat_preprocess(sat_state)==2, "added clause: sat_preprocess() takes 3");
+  check(solved(sat_state), "added clause: the cnf and 3 are unsatisfiable");
+  sat_state_free(sat_state);
+  sat_state = sat_state_from_clauses(4,4,sizes,literals);
+  check(sat_add_clause(unit,1,sat_state), "added clause: sat_add_clause() fails");
+  check(sat_preprocess(sat_state)==2, "added clause: sat_preprocess() takes it");
+  check(sat_preprocess_count(sat_state)==2, "added clause: sat_preprocess_count() takes it");
+  check(!sat_state_save(sat_state,"check_api.snapshot"), "added clause: sat_state_save() takes it");
+  check(!solved(sat_state), "added clause: sat_solve() finds a model");
+  sat_state_free(sat_state);
+}
+
+//(1 2) () (-1) from sat_state_from_clauses(), unsatisfiable by its empty clause
+void check_empty_clause() {
+  c2dSize sizes[] = { 2, 0, 1 };
+  c2dLiteral literals[] = { 1, 2, -1 };
+  SatState* sat_state = sat_state_from_clauses(2,3,sizes,literals);
+
+  check(!sat_unit_resolution(sat_state), "empty clause: sat_unit_resolution() succeeds");
+  sat_undo_unit_resolution(sat_state);
+  check(!solved(sat_state), "empty clause: sat_solve() finds a model");
+  sat_state_free(sat_state);
+}
+
+int main(int argc, char* argv[]) {
+  check_added_clause();
+  check_empty_clause();
+  printf("%d errors\n", errors);
+  return errors ? 1 : 0;
+}
+
+/******************************************************************************
+ * end
+ ******************************************************************************/
@@ -0,0 +1,117 @@
+import os
+import sys
+import subprocess
+
+# checks the sat solver on cnf files, see README, with each set of OPTIONS:
+# --the answer against the name of the file (-s or -u)
+# --the v line of -m against every clause of the cnf
+# --for files of at most ENUMERATE_MAX variables, the answer and the b line of -b against all the
+#   models of the cnf, enumerated here without the sat solver
+
+ENUMERATE_MAX = 20
+
+OPTIONS = (["-m", "-b"], ["-m", "-b", "-p"],
+           ["-m", "-b", "-r", "glucose"], ["-m", "-b", "-r", "none"],
+           ["-m", "-b", "-t", "4"], ["-m", "-b", "-p", "-t", "4", "-r", "glucose"])
+
+if len(sys.argv) < 3:
+	print("Usage: python check_sat.py sat cnfFile...")
+	sys.exit(2)
+
+sat = sys.argv[1]
+files = sys.argv[2:]
+
+# the variable count and the clauses of a cnf file, up to the % line that ends some of them
+def readCnf(cnfFile):
+	n = 0
+	clauses = []
+	clause = []
+	for line in open(cnfFile):
+		line = line.strip()
+		if line.startswith("%"):
+			break
+		if line == "" or line.startswith("c"):
+			continue
+		if line.startswith("p"):
+			n = int(line.split()[2])
+			continue
+		for token in line.split():
+			literal = int(token)
+			if literal == 0:
+				clauses.append(clause)
+				clause = []
+			else:
+				clause.append(literal)
+	return n, clauses
+
+# the answer (SAT or UNSAT), the v line and the b line of a run, each line as a set of literals
+def run(cnfFile, options):
+	out = subprocess.run([sat, "-c", cnfFile] + options, stdout=subprocess.PIPE,
+	                     universal_newlines=True).stdout
+	answer = None
+	model = None
+	backbone = None
+	for line in out.splitlines():
+		if line in ("SAT", "UNSAT"):
+			answer = line
+		elif line.startswith("v ") or line.startswith("b "):
+			literals = set(int(x) for x in line[2:].split() if x != "0")
+			if line[0] == "v":
+				model = literals
+			else:
+				backbone = literals
+	return answer, model, backbone
+
+# the literals true in all the models of the cnf, None if it has none
+# every assignment of the variables 1..n, in order, is tried but for those cut off once a clause
+# has all its variables set and none of its literals true
+def enumerate_backbone(n, clauses):
+	ends = [[] for v in range(n+1)]  # per variable, the clauses whose last variable it is
+	for clause in clauses:
+		ends[max(abs(x) for x in clause) if clause else 0].append(clause)
+	if ends[0]:
+		return None  # the empty clause
+	value = [False]*(n+1)
+	backbone = [None]  # the literals of all the models so far
+	def extend(v):
+		if v > n:
+			model = set(x if value[x] else -x for x in range(1, n+1))
+			backbone[0] = model if backbone[0] is None else backbone[0] & model
+			return
+		for value[v] in (True, False):
+			if all(any(value[x] if x > 0 else not value[-x] for x in clause) for clause in ends[v]):
+				extend(v+1)
+	extend(1)
+	return backbone[0]
+
+errors = 0
+for cnfFile in files:
+	n, clauses = readCnf(cnfFile)
+	name = os.path.basename(cnfFile)
+	expected = "SAT" if "-s" in name else "UNSAT" if "-u" in name else None
+	backbone = None
+	if n <= ENUMERATE_MAX:
+		backbone = enumerate_backbone(n, clauses)
+		enumerated = "SAT" if backbone is not None else "UNSAT"
+		if expected is not None and enumerated != expected:
+			errors += 1
+			print("%s: %s by its name, %s by its models" % (name, expected, enumerated))
+		expected = enumerated
+	for options in OPTIONS:
+		answer, model, found = run(cnfFile, options)
+		error = None
+		if answer is None or (expected is not None and answer != expected):
+			error = "answer %s" % answer
+		elif answer == "SAT":
+			if model is None or any(not (set(clause) & model) for clause in clauses):
+				error = "the v line does not satisfy the cnf"
+			elif found is None:
+				error = "no b line"
+			elif backbone is not None and found != backbone:
+				error = "b line %s, backbone %s" % (sorted(found), sorted(backbone))
+		if error is not None:
+			errors += 1
+			print("%s %s: %s" % (name, " ".join(options), error))
+
+print("%d files, %d errors" % (len(files), errors))
+sys.exit(1 if errors else 0)